@@ -12,6 +12,7 @@
 #include "cirMgr.h"
 #include "cirGate.h"
 #include "cirCmd.h"
+#include "cirStream.h"
 #include "util.h"
 
 using namespace std;
@@ -27,10 +28,14 @@ initCirCmd()
          cmdMgr->regCmd("CIRGate", 4, new CirGateCmd) &&
          cmdMgr->regCmd("CIRSWeep", 5, new CirSweepCmd) &&
          cmdMgr->regCmd("CIROPTimize", 6, new CirOptCmd) &&
+         cmdMgr->regCmd("CIRORDer", 6, new CirOrderCmd) &&
          cmdMgr->regCmd("CIRSTRash", 6, new CirStrashCmd) &&
          cmdMgr->regCmd("CIRSIMulate", 6, new CirSimCmd) &&
          cmdMgr->regCmd("CIRFraig", 4, new CirFraigCmd) &&
+         cmdMgr->regCmd("CIRCONVert", 7, new CirConvertCmd) &&
          cmdMgr->regCmd("CIRWrite", 4, new CirWriteCmd) &&
+         cmdMgr->regCmd("CIRSAve", 5, new CirSaveCmd) &&
+         cmdMgr->regCmd("CIRLoad", 4, new CirLoadCmd) &&
          cmdMgr->regCmd("FUCK", 4, new CirFuck) &&
          cmdMgr->regCmd("SHIT", 4, new CirShit)
       )) {
@@ -56,7 +61,7 @@ enum CirCmdState
 static CirCmdState curCmd = CIRINIT;
 
 //----------------------------------------------------------------------
-//    CIRRead <(string fileName)> [-Replace]
+//    CIRRead <(string fileName)> [-Image] [-Replace]
 //----------------------------------------------------------------------
 CmdExecStatus
 CirReadCmd::exec(const string& option)
@@ -68,19 +73,25 @@ CirReadCmd::exec(const string& option)
    if (options.empty())
       return CmdExec::errorOption(CMD_OPT_MISSING, "");
 
-   bool doReplace = false;
+   bool doReplace = false, doImage = false;
    string fileName;
    for (size_t i = 0, n = options.size(); i < n; ++i) {
       if (myStrNCmp("-Replace", options[i], 2) == 0) {
          if (doReplace) return CmdExec::errorOption(CMD_OPT_EXTRA,options[i]);
          doReplace = true;
       }
+      else if (myStrNCmp("-Image", options[i], 2) == 0) {
+         if (doImage) return CmdExec::errorOption(CMD_OPT_EXTRA,options[i]);
+         doImage = true;
+      }
       else {
          if (fileName.size())
             return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
          fileName = options[i];
       }
    }
+   if (fileName.empty())
+      return CmdExec::errorOption(CMD_OPT_MISSING, "");
 
    if (cirMgr != 0) {
       if (doReplace) {
@@ -95,7 +106,7 @@ CirReadCmd::exec(const string& option)
    }
    cirMgr = new CirMgr;
 
-   if (!cirMgr->readCircuit(fileName)) {
+   if (!(doImage ? cirMgr->readImage(fileName) : cirMgr->readCircuit(fileName))) {
       curCmd = CIRINIT;
       delete cirMgr; cirMgr = 0;
       return CMD_EXEC_ERROR;
@@ -109,7 +120,7 @@ CirReadCmd::exec(const string& option)
 void
 CirReadCmd::usage(ostream& os) const
 {
-   os << "Usage: CIRRead <(string fileName)> [-Replace]" << endl;
+   os << "Usage: CIRRead <(string fileName)> [-Image] [-Replace]" << endl;
 }
 
 void
@@ -120,7 +131,8 @@ CirReadCmd::help() const
 }
 
 //----------------------------------------------------------------------
-//    CIRPrint [-Summary | -Netlist | -PI | -PO | -FLoating | -FECpairs]
+//    CIRPrint [-Summary | -Netlist | -PI | -PO | -FLoating | -FECpairs
+//              | -SImstats]
 //----------------------------------------------------------------------
 CmdExecStatus
 CirPrintCmd::exec(const string& option)
@@ -146,6 +158,8 @@ CirPrintCmd::exec(const string& option)
       cirMgr->printFloatGates();
    else if (myStrNCmp("-FECpairs", token, 4) == 0)
       cirMgr->printFECPairs();
+   else if (myStrNCmp("-SImstats", token, 3) == 0)
+      cirMgr->printSimStats();
    else
       return CmdExec::errorOption(CMD_OPT_ILLEGAL, token);
 
@@ -156,7 +170,8 @@ void
 CirPrintCmd::usage(ostream& os) const
 {  
    os << "Usage: CIRPrint [-Summary | -Netlist | -PI | -PO | -FLoating "
-      << "| -FECpairs]" << endl;
+      << "| -FECpairs\n"
+      << "                 | -SImstats]" << endl;
 }
 
 void
@@ -329,6 +344,47 @@ CirOptCmd::help() const
         << "perform trivial optimizations\n";
 }
 
+//----------------------------------------------------------------------
+//    CIRORDer
+//----------------------------------------------------------------------
+CmdExecStatus
+CirOrderCmd::exec(const string& option)
+{
+   if (!cirMgr) {
+      cerr << "Error: circuit is not yet constructed!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // check option
+   vector<string> options;
+   CmdExec::lexOptions(option, options);
+
+   if (!options.empty())
+      return CmdExec::errorOption(CMD_OPT_EXTRA, options[0]);
+
+   assert(curCmd != CIRINIT);
+   if (curCmd == CIRSIMULATE) {
+      cerr << "Error: circuit has been simulated!! Do \"CIRFraig\" first!!"
+           << endl;
+      return CMD_EXEC_ERROR;
+   }
+   cirMgr->reorder();
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirOrderCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRORDer" << endl;
+}
+
+void
+CirOrderCmd::help() const
+{
+   cout << setw(15) << left << "CIRORDer: "
+        << "renumber gates in DFS order\n";
+}
+
 //----------------------------------------------------------------------
 //    CIRSTRash
 //----------------------------------------------------------------------
@@ -376,31 +432,51 @@ CirStrashCmd::help() const
 }
 
 //----------------------------------------------------------------------
-//    CIRSIMulate <-Random | -File <string patternFile>>
-//                [-Output (string logFile)]
+//    CIRSIMulate <-Random [-Patterns (int n)] [-Time (int sec)]
+//                         [-Stall (int rounds)]
+//                | -File <string patternFile>>
+//                [-Output (string logFile) [-Binary]]
+//    CIRSIMulate -STReam <string imageFile> [-Patterns (int n)]
+//                [-Output (string logFile)] [-SIGnature (string sigFile)]
 //----------------------------------------------------------------------
 CmdExecStatus
 CirSimCmd::exec(const string& option)
 {
-   if (!cirMgr) {
-      cerr << "Error: circuit is not yet constructed!!" << endl;
-      return CMD_EXEC_ERROR;
-   }
    // check option
    vector<string> options;
    CmdExec::lexOptions(option, options);
 
    ifstream patternFile;
-   ofstream logFile;
-   bool doRandom = false, doFile = false, doLog = false;
+   ofstream logFile, sigFile;
+   string logName, imageName, sigName, sigOpt;
+   bool doRandom = false, doFile = false, doLog = false, doBinary = false;
+   bool doStream = false;
+   int budgetPat = 0, budgetTime = 0, budgetStall = 0;
+   string budgetOpt;
    for (size_t i = 0, n = options.size(); i < n; ++i) {
       if (myStrNCmp("-Random", options[i], 2) == 0) {
-         if (doRandom || doFile)
+         if (doRandom || doFile || doStream)
             return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
          doRandom = true;
       }
+      else if (myStrNCmp("-STReam", options[i], 4) == 0) {
+         if (doRandom || doFile || doStream)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         imageName = options[i];
+         doStream = true;
+      }
+      else if (myStrNCmp("-SIGnature", options[i], 4) == 0) {
+         if (sigName.size())
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         sigOpt = options[i];
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         sigName = options[i];
+      }
       else if (myStrNCmp("-File", options[i], 2) == 0) {
-         if (doRandom || doFile)
+         if (doRandom || doFile || doStream)
             return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
          if (++i == n)
             return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
@@ -414,25 +490,79 @@ CirSimCmd::exec(const string& option)
             return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
          if (++i == n)
             return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
-         logFile.open(options[i].c_str(), ios::out);
-         if (!logFile)
-            return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, options[i]);
+         logName = options[i];
          doLog = true;
       }
+      else if (myStrNCmp("-Patterns", options[i], 2) == 0 ||
+               myStrNCmp("-Time", options[i], 2) == 0 ||
+               myStrNCmp("-Stall", options[i], 2) == 0) {
+         int* budget = (myStrNCmp("-Patterns", options[i], 2) == 0 ? &budgetPat :
+                        myStrNCmp("-Time", options[i], 2) == 0 ? &budgetTime : &budgetStall);
+         if (*budget)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (budgetOpt.empty()) budgetOpt = options[i];
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         if (!myStr2Int(options[i], *budget) || *budget <= 0)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+      }
+      else if (myStrNCmp("-Binary", options[i], 2) == 0) {
+         if (doBinary)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         doBinary = true;
+      }
       else
          return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
    }
 
+   if (doStream) {
+      // the circuit of the image is never built, so no cirMgr is needed
+      if (budgetTime || budgetStall)
+         return CmdExec::errorOption(CMD_OPT_EXTRA, budgetOpt);
+      CirStreamSim stream;
+      if (!stream.open(imageName))
+         return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, imageName);
+      if (doLog) {
+         logFile.open(logName.c_str(), ios::out | ios::binary);
+         if (!logFile)
+            return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, logName);
+      }
+      if (sigName.size()) {
+         sigFile.open(sigName.c_str(), ios::out | ios::binary);
+         if (!sigFile)
+            return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, sigName);
+      }
+      stream.run(budgetPat ? budgetPat : 64 * 64, doLog ? &logFile : 0,
+                 sigName.size() ? &sigFile : 0);
+      return CMD_EXEC_DONE;
+   }
+   if (sigName.size())
+      return CmdExec::errorOption(CMD_OPT_ILLEGAL, sigOpt);
+   if (!cirMgr) {
+      cerr << "Error: circuit is not yet constructed!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
    if (!doRandom && !doFile)
       return CmdExec::errorOption(CMD_OPT_MISSING, "");
+   if (doBinary && !doLog)
+      return CmdExec::errorOption(CMD_OPT_MISSING, "-Output");
+   if (budgetOpt.size() && !doRandom)
+      return CmdExec::errorOption(CMD_OPT_EXTRA, budgetOpt);
+   if (doLog) {
+      logFile.open(logName.c_str(), doBinary? ios::out | ios::binary: ios::out);
+      if (!logFile)
+         return CmdExec::errorOption(CMD_OPT_FOPEN_FAIL, logName);
+   }
 
    assert (curCmd != CIRINIT);
    if (doLog)
-      cirMgr->setSimLog(&logFile);
+      cirMgr->setSimLog(&logFile, doBinary);
    else cirMgr->setSimLog(0);
 
-   if (doRandom)
+   if (doRandom) {
+      cirMgr->setSimBudget(budgetPat, budgetTime, budgetStall);
       cirMgr->randomSim();
+   }
    else
       cirMgr->fileSim(patternFile);
    cirMgr->setSimLog(0);
@@ -444,8 +574,13 @@ CirSimCmd::exec(const string& option)
 void
 CirSimCmd::usage(ostream& os) const
 {
-   os << "Usage: CIRSIMulate <-Random | -File <string patternFile>>\n"
-      << "                   [-Output (string logFile)]" << endl;
+   os << "Usage: CIRSIMulate <-Random [-Patterns (int n)] [-Time (int sec)]\n"
+      << "                            [-Stall (int rounds)]\n"
+      << "                   | -File <string patternFile>>\n"
+      << "                   [-Output (string logFile) [-Binary]]\n"
+      << "       CIRSIMulate -STReam <string imageFile> [-Patterns (int n)]\n"
+      << "                   [-Output (string logFile)] [-SIGnature (string sigFile)]"
+      << endl;
 }
 
 void
@@ -456,7 +591,39 @@ CirSimCmd::help() const
 }
 
 //----------------------------------------------------------------------
-//    CIRFraig
+//    CIRCONVert <(string inFile)> <(string outFile)>
+//----------------------------------------------------------------------
+CmdExecStatus
+CirConvertCmd::exec(const string& option)
+{
+   // check option
+   vector<string> options;
+   if (!CmdExec::lexOptions(option, options, 2))
+      return CMD_EXEC_ERROR;
+
+   if (!convertPatFile(options[0], options[1]))
+      return CMD_EXEC_ERROR;
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirConvertCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRCONVert <(string inFile)> <(string outFile)>" << endl;
+}
+
+void
+CirConvertCmd::help() const
+{
+   cout << setw(15) << left << "CIRCONVert: "
+        << "convert a pattern file between text and packed binary\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRFraig [-Checkpoint (string sessionFile) [-Every (int satCalls)]]
+//             [-Threads (int n) | -SPeculate | -SChedule [-TRace (string file)]]
+//             [-ConfBudget (int conflicts) [-Retry (int conflicts)]]
 //----------------------------------------------------------------------
 CmdExecStatus
 CirFraigCmd::exec(const string& option)
@@ -469,14 +636,92 @@ CirFraigCmd::exec(const string& option)
    vector<string> options;
    CmdExec::lexOptions(option, options);
 
-   if (!options.empty())
-      return CmdExec::errorOption(CMD_OPT_EXTRA, options[0]);
+   string ckptFile;
+   int every = 0, threads = 0, budget = -1, retry = -1;
+   bool spec = false, sched = false;
+   string trace;
+   for (size_t i = 0, n = options.size(); i < n; ++i) {
+      if (myStrNCmp("-Checkpoint", options[i], 2) == 0) {
+         if (ckptFile.size())
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         ckptFile = options[i];
+      }
+      else if (myStrNCmp("-Every", options[i], 2) == 0) {
+         if (every)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         if (!myStr2Int(options[i], every) || every <= 0)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+      }
+      else if (myStrNCmp("-Threads", options[i], 2) == 0) {
+         if (threads || spec || sched)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         if (!myStr2Int(options[i], threads) || threads <= 0)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+      }
+      else if (myStrNCmp("-SPeculate", options[i], 3) == 0) {
+         if (spec || threads || sched)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         spec = true;
+      }
+      else if (myStrNCmp("-SChedule", options[i], 3) == 0) {
+         if (sched || threads || spec)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         sched = true;
+      }
+      else if (myStrNCmp("-TRace", options[i], 3) == 0) {
+         if (trace.size())
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         trace = options[i];
+      }
+      else if (myStrNCmp("-ConfBudget", options[i], 3) == 0) {
+         if (budget >= 0)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         if (!myStr2Int(options[i], budget) || budget <= 0)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+      }
+      else if (myStrNCmp("-Retry", options[i], 2) == 0) {
+         if (retry >= 0)
+            return CmdExec::errorOption(CMD_OPT_EXTRA, options[i]);
+         if (++i == n)
+            return CmdExec::errorOption(CMD_OPT_MISSING, options[i-1]);
+         if (!myStr2Int(options[i], retry) || retry <= 0)
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+      }
+      else
+         return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+   }
+   if (every && ckptFile.empty())
+      return CmdExec::errorOption(CMD_OPT_MISSING, "-Checkpoint");
+   if (trace.size() && !sched)
+      return CmdExec::errorOption(CMD_OPT_MISSING, "-SChedule");
+   if (retry > 0 && budget < 0)
+      return CmdExec::errorOption(CMD_OPT_MISSING, "-ConfBudget");
 
    if (curCmd != CIRSIMULATE) {
       cerr << "Error: circuit is not yet simulated!!" << endl;
       return CMD_EXEC_ERROR;
    }
+   cirMgr->setCheckpoint(ckptFile, every ? every : 1000);
+   cirMgr->setThreads(threads ? threads : 1);
+   cirMgr->setSpeculate(spec);
+   cirMgr->setSchedule(sched, trace);
+   cirMgr->setConfBudget(budget, retry);
    cirMgr->fraig();
+   cirMgr->setCheckpoint("", 0);
+   cirMgr->setThreads(1);
+   cirMgr->setSpeculate(false);
+   cirMgr->setSchedule(false, "");
+   cirMgr->setConfBudget(-1, -1);
    curCmd = CIRFRAIG;
 
    return CMD_EXEC_DONE;
@@ -485,7 +730,10 @@ CirFraigCmd::exec(const string& option)
 void
 CirFraigCmd::usage(ostream& os) const
 {
-   os << "Usage: CIRFraig" << endl;
+   os << "Usage: CIRFraig [-Checkpoint (string sessionFile) "
+      << "[-Every (int satCalls)]] [-Threads (int n) | -SPeculate\n"
+      << "                | -SChedule [-TRace (string file)]]\n"
+      << "                [-ConfBudget (int conflicts) [-Retry (int conflicts)]]" << endl;
 }
 
 void
@@ -497,6 +745,7 @@ CirFraigCmd::help() const
 
 //----------------------------------------------------------------------
 //    CIRWrite [(int gateId)][-Output (string aagFile)]
+//             | -Image (string imageFile)
 //----------------------------------------------------------------------
 CmdExecStatus
 CirWriteCmd::exec(const string& option)
@@ -513,6 +762,15 @@ CirWriteCmd::exec(const string& option)
       cirMgr->writeAag(cout);
       return CMD_EXEC_DONE;
    }
+   if (myStrNCmp("-Image", options[0], 2) == 0) {
+      if (options.size() == 1)
+         return CmdExec::errorOption(CMD_OPT_MISSING, options[0]);
+      if (options.size() > 2)
+         return CmdExec::errorOption(CMD_OPT_EXTRA, options[2]);
+      if (!cirMgr->writeImage(options[1]))
+         return CMD_EXEC_ERROR;
+      return CMD_EXEC_DONE;
+   }
    bool hasFile = false;
    int gateId;
    CirGate *thisGate = NULL;
@@ -557,7 +815,8 @@ CirWriteCmd::exec(const string& option)
 void
 CirWriteCmd::usage(ostream& os) const
 {
-   os << "Usage: CIRWrite [(int gateId)][-Output (string aagFile)]" << endl;
+   os << "Usage: CIRWrite [(int gateId)][-Output (string aagFile)]\n"
+      << "                | -Image (string imageFile)" << endl;
 }
 
 void
@@ -567,6 +826,105 @@ CirWriteCmd::help() const
         << "write the netlist to an ASCII AIG file (.aag)\n";
 }
 
+//----------------------------------------------------------------------
+//    CIRSAve <(string sessionFile)>
+//----------------------------------------------------------------------
+CmdExecStatus
+CirSaveCmd::exec(const string& option)
+{
+   if (!cirMgr) {
+      cerr << "Error: circuit is not yet constructed!!" << endl;
+      return CMD_EXEC_ERROR;
+   }
+   // check option
+   string token;
+   if (!CmdExec::lexSingleOption(option, token, false))
+      return CMD_EXEC_ERROR;
+
+   if (!cirMgr->saveSession(token))
+      return CMD_EXEC_ERROR;
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirSaveCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRSAve <(string sessionFile)>" << endl;
+}
+
+void
+CirSaveCmd::help() const
+{
+   cout << setw(15) << left << "CIRSAve: "
+        << "save the circuit, FEC groups and proofs to a session file\n";
+}
+
+//----------------------------------------------------------------------
+//    CIRLoad <(string sessionFile)> [-Replace]
+//----------------------------------------------------------------------
+CmdExecStatus
+CirLoadCmd::exec(const string& option)
+{
+   // check option
+   vector<string> options;
+   if (!CmdExec::lexOptions(option, options))
+      return CMD_EXEC_ERROR;
+   if (options.empty())
+      return CmdExec::errorOption(CMD_OPT_MISSING, "");
+
+   bool doReplace = false;
+   string fileName;
+   for (size_t i = 0, n = options.size(); i < n; ++i) {
+      if (myStrNCmp("-Replace", options[i], 2) == 0) {
+         if (doReplace) return CmdExec::errorOption(CMD_OPT_EXTRA,options[i]);
+         doReplace = true;
+      }
+      else {
+         if (fileName.size())
+            return CmdExec::errorOption(CMD_OPT_ILLEGAL, options[i]);
+         fileName = options[i];
+      }
+   }
+
+   if (cirMgr != 0) {
+      if (doReplace) {
+         cerr << "Note: original circuit is replaced..." << endl;
+         curCmd = CIRINIT;
+         delete cirMgr; cirMgr = 0;
+      }
+      else {
+         cerr << "Error: circuit already exists!!" << endl;
+         return CMD_EXEC_ERROR;
+      }
+   }
+   cirMgr = new CirMgr;
+
+   if (!cirMgr->loadSession(fileName)) {
+      curCmd = CIRINIT;
+      delete cirMgr; cirMgr = 0;
+      return CMD_EXEC_ERROR;
+   }
+
+   // a session with FEC groups goes on with CIRFraig
+   curCmd = (cirMgr->numFecGroups() ? CIRSIMULATE : CIRREAD);
+
+   return CMD_EXEC_DONE;
+}
+
+void
+CirLoadCmd::usage(ostream& os) const
+{
+   os << "Usage: CIRLoad <(string sessionFile)> [-Replace]" << endl;
+}
+
+void
+CirLoadCmd::help() const
+{
+   cout << setw(15) << left << "CIRLoad: "
+        << "resume a session saved by CIRSAve or CIRFraig -Checkpoint\n";
+}
+
 //=================================================================
 
 CmdExecStatus
@@ -16,10 +16,14 @@ CmdClass(CirPrintCmd);
 CmdClass(CirGateCmd);
 CmdClass(CirSweepCmd);
 CmdClass(CirOptCmd);
+CmdClass(CirOrderCmd);
 CmdClass(CirStrashCmd);
 CmdClass(CirSimCmd);
 CmdClass(CirFraigCmd);
+CmdClass(CirConvertCmd);
 CmdClass(CirWriteCmd);
+CmdClass(CirSaveCmd);
+CmdClass(CirLoadCmd);
 CmdClass(CirFuck);
 CmdClass(CirShit);
 
@@ -0,0 +1,256 @@
+/****************************************************************************
+  FileName     [ cirFec.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define the partition-refinement store of FEC groups ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <iostream>
+#include <algorithm>
+#include <cassert>
+#include "cirFec.h"
+#include "cirGate.h"
+
+using namespace std;
+
+/*******************************/
+/*   Global variable and enum  */
+/*******************************/
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+/**************************************/
+/*   class FecStore member functions  */
+/**************************************/
+void FecStore::clear() {
+  _mem.clear(); _cls.clear(); _live.clear(); _link = false; _sorted = true;
+}
+
+void FecStore::init(const FEC& members) {
+  clear();
+  if (members.size() < 2) return;
+  _mem = members;
+  newGroup(0, _mem.size());
+}
+
+void FecStore::add(const FEC& members, bool exact) {
+  assert(!_link);
+  if (members.size() < 2) return;
+  const unsigned begin = _mem.size();
+  _mem.insert(_mem.end(), members.begin(), members.end());
+  newGroup(begin, _mem.size());
+  _cls.back().exact = exact;
+}
+
+void FecStore::swap(FecStore& s) {
+  _mem.swap(s._mem); _cls.swap(s._cls); _live.swap(s._live);
+  ::swap(_link, s._link); ::swap(_sorted, s._sorted);
+}
+
+void FecStore::newGroup(unsigned begin, unsigned end) {
+  FecCls c;
+  c.begin = begin; c.end = end; c.notChange = 0; c.pos = _live.size();
+  c.exact = false;
+  _cls.push_back(c);
+  _live.push_back(_cls.size() - 1);
+  _sorted = false;
+  if (!_link) return;
+  for (unsigned j = begin; j < end; ++j) _mem[j].second->setFec(_cls.size() - 1);
+}
+
+bool FecStore::split(size_t pos, bool keepPos) {
+  unsigned id = _live[pos];
+  if (regroup(id)) return true;
+  if (keepPos) return false;
+  _live[pos] = _live.back(); _live.pop_back();
+  if (pos < _live.size()) _cls[_live[pos]].pos = pos;
+  return false;
+}
+
+bool FecStore::splitId(unsigned id) {
+  assert(id < _cls.size());
+  return regroup(id);
+}
+
+// Splits group id by the current SimKeys, together with the keys of gates
+// kept outside the store (the representatives of fraig): a member is not
+// dropped as a singleton if one of keys equals its own. grp[k] gets the id
+// of the group with the key keys[k], or -1 if no member has it.
+bool FecStore::splitId(unsigned id, const vector<Simtype>& keys, vector<int>& grp) {
+  assert(id < _cls.size());
+  _keys = keys;
+  std::sort(_keys.begin(), _keys.end());
+  const bool alive = regroup(id, true);
+  grp.assign(keys.size(), -1);
+  if (!alive) return false;
+  // run 0 kept id, the others got the last new ids in order
+  const size_t runs = _run.size() / 2;
+  for (size_t k = 0; k < runs; ++k) {
+    const Simtype sig = _rec[_run[2*k]].sig;
+    const int g = (k ? int(_cls.size() - runs + k) : int(id));
+    for (size_t j = 0; j < keys.size(); ++j)
+      if (keys[j] == sig) grp[j] = g;
+  }
+  return true;
+}
+
+// updates the SimKeys of group id from its gates and splits it if they
+// differ; returns true on a split. The group stays in the live list even
+// if it is gone, until compact().
+// SimKey::update() picks the phase per word, so a gate that is equal to
+// another in one word and inverted in the next stays with it. With phase
+// (by gate id), the phase of every gate is fixed instead, which keeps the
+// groups exact over many words.
+bool FecStore::refineId(unsigned id, const vector<char>* phase) {
+  const FecCls& c = _cls[id];
+  if (c.end - c.begin < 2) return false;
+  SimNode* m = &_mem[c.begin];
+  const unsigned len = c.end - c.begin;
+  bool split = false;
+  for (unsigned j = 0; j < len; ++j) {
+    const Simtype v = m[j].second->value();
+    if (!phase) m[j].first.update(v);
+    else {
+      const bool inv = (*phase)[m[j].second->getId()];
+      m[j].first.set(inv ? ~v : v, inv);
+    }
+    if (m[j].first() != m[0].first()) split = true;
+  }
+  if (split) regroup(id);
+  return split;
+}
+
+// drops the groups that are gone, keeping the order of the others
+void FecStore::compact() {
+  size_t n = 0;
+  for (size_t i = 0; i < _live.size(); ++i) {
+    if (_cls[_live[i]].pos == -1) continue;
+    _live[n] = _live[i]; _cls[_live[n]].pos = n; ++n;
+  }
+  _live.resize(n);
+}
+
+// removes member j from group id; the gate keeps its link
+void FecStore::erase(unsigned id, size_t j) {
+  FecCls& c = _cls[id];
+  assert(c.begin + j < c.end);
+  ::swap(_mem[c.begin + j], _mem[c.end - 1]);
+  --c.end; _sorted = false;
+}
+
+// Recomputes the phase-normalized SimKeys of all live groups from the
+// values of their gates in one pass over the member array, then splits
+// every group that is not uniform any more. Returns the #groups split;
+// diff gets the XOR of the first two different keys of each of them.
+size_t FecStore::refine(vector<Simtype>& diff) {
+  size_t nSplit = 0;
+  const size_t n = _live.size();
+  for (size_t pos = 0; pos < n; ++pos) {
+    const FecCls& c = _cls[_live[pos]];
+    SimNode* m = &_mem[c.begin];
+    const unsigned len = c.end - c.begin;
+    m[0].first.update(m[0].second->value());
+    const Simtype k0 = m[0].first();
+    Simtype d = 0;
+    for (unsigned j = 1; j < len; ++j) {
+      m[j].first.update(m[j].second->value());
+      if (!d) d = m[j].first() ^ k0;
+    }
+    if (!d) { ++_cls[_live[pos]].notChange; continue; }
+    diff.push_back(d); ++nSplit;
+    regroup(_live[pos]); // new groups go to the end and are not revisited
+  }
+  if (nSplit) compact();
+  return nSplit;
+}
+
+// Partitions the members of group id by their current SimKeys: the
+// (signature, index) pairs are sorted, so the equal keys form runs and
+// every run keeps the original order of its members. No hash table is
+// built. Returns false if no group of two or more members is left; with
+// withKeys, a single member with a key in _keys is a group as well.
+bool FecStore::regroup(unsigned id, bool withKeys) {
+  const unsigned begin = _cls[id].begin, n = _cls[id].end - begin;
+  SimNode* m = &_mem[begin];
+  _rec.resize(n);
+  for (unsigned j = 0; j < n; ++j) { _rec[j].sig = m[j].first(); _rec[j].idx = j; }
+  std::sort(_rec.begin(), _rec.end());
+
+  // runs of two or more; the one of the first member goes first
+  _run.clear();
+  for (unsigned r = 0, e; r < n; r = e) {
+    for (e = r + 1; e < n && _rec[e].sig == _rec[r].sig; ++e) ;
+    if (e - r < 2 && !(withKeys && binary_search(_keys.begin(), _keys.end(), _rec[r].sig)))
+      continue;
+    if (_rec[r].idx == 0 && _run.size()) {
+      _run.insert(_run.begin(), e); _run.insert(_run.begin(), r);
+    } else { _run.push_back(r); _run.push_back(e); }
+  }
+  if (_run.size() == 2 && _run[1] - _run[0] == n) return true; // no split
+  _sorted = false;
+
+  _buf.assign(m, m + n);
+  unsigned off = 0;
+  for (size_t k = 0; k < _run.size(); k += 2)
+    for (unsigned r = _run[k]; r < _run[k+1]; ++r) m[off++] = _buf[_rec[r].idx];
+  const unsigned kept = off;
+  for (unsigned r = 0, e; r < n; r = e) {
+    for (e = r + 1; e < n && _rec[e].sig == _rec[r].sig; ++e) ;
+    if (e - r == 1 && !(withKeys && binary_search(_keys.begin(), _keys.end(), _rec[r].sig)))
+      m[off++] = _buf[_rec[r].idx];
+  }
+  assert(off == n);
+
+  if (_link)
+    for (unsigned j = kept; j < n; ++j) m[j].second->resetFEC();
+  if (!_run.size()) {
+    _cls[id].end = _cls[id].begin; _cls[id].pos = -1;
+    return false;
+  }
+  unsigned b = begin + _run[1] - _run[0];
+  _cls[id].end = b; _cls[id].notChange = 0;
+  for (size_t k = 2; k < _run.size(); k += 2) {
+    newGroup(b, b + _run[k+1] - _run[k]);
+    b += _run[k+1] - _run[k];
+  }
+  return true;
+}
+
+static bool lessId(const SimNode& a, const SimNode& b) {
+  return a.second->getOrigId() < b.second->getOrigId();
+}
+
+// members by original id, then groups by their first member, so that
+// CIRORDer changes neither; O(n log n)
+void FecStore::sort() {
+  for (size_t i = 0; i < _live.size(); ++i) {
+    FecCls& c = _cls[_live[i]];
+    std::sort(_mem.begin() + c.begin, _mem.begin() + c.end, lessId);
+  }
+  _first.resize(_cls.size());
+  for (size_t i = 0; i < _live.size(); ++i) {
+    FecGrp g = group(_live[i]);
+    _first[_live[i]] = (g.size() ? g[0].second->getOrigId() : unsigned(-1));
+  }
+  std::sort(_live.begin(), _live.end(), FirstLess(_first));
+  for (size_t i = 0; i < _live.size(); ++i) _cls[_live[i]].pos = i;
+  _sorted = true;
+}
+
+// gives the live groups the ids 0, 1, ... in list order and links their
+// members to them
+void FecStore::renumber() {
+  compact();
+  vector<FecCls> cls(_live.size());
+  for (size_t i = 0; i < _live.size(); ++i) {
+    cls[i] = _cls[_live[i]]; cls[i].pos = i;
+    _live[i] = i;
+  }
+  _cls.swap(cls);
+  _link = true;
+  for (size_t i = 0; i < _cls.size(); ++i)
+    for (unsigned j = _cls[i].begin; j < _cls[i].end; ++j)
+      _mem[j].second->setFec(i);
+}
@@ -0,0 +1,125 @@
+/****************************************************************************
+  FileName     [ cirFec.h ]
+  PackageName  [ cir ]
+  Synopsis     [ Define the partition-refinement store of FEC groups ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#ifndef CIR_FEC_H
+#define CIR_FEC_H
+
+#include <vector>
+#include <cassert>
+#include "cirDef.h"
+
+using namespace std;
+
+// The members of one FEC group; a view into FecStore, so it stays valid
+// as long as the group is not split
+class FecGrp
+{
+public:
+  FecGrp(SimNode* m = 0, size_t n = 0) : _m(m), _n(n) {}
+  size_t size() const { return _n; }
+  SimNode& operator [] (size_t i) const { return _m[i]; }
+  SimNode& at(size_t i) const { assert(i < _n); return _m[i]; }
+private:
+  SimNode*  _m;
+  size_t    _n;
+};
+
+// All groups share one member array and group c owns the contiguous range
+// [begin, end) of it. A split regroups the range of c in place by the
+// current SimKeys: the group of the first member keeps id c, the others
+// get new ids at the end, and the singletons drop out. The member array
+// never grows, so ids and FecGrp views do not dangle.
+//
+// The live groups are also kept in a list, in the order simulation visits
+// them; operator [] and size() work on that list, group() on the ids.
+// Gates are linked to the id of their group by renumber(), after which
+// splits keep the links up to date.
+class FecStore
+{
+public:
+  FecStore() : _link(false), _sorted(true) {}
+  ~FecStore() {}
+
+  void clear();
+  void init(const FEC&);
+  // adds a group while the store is built, before renumber()
+  void add(const FEC&, bool exact = false);
+  void swap(FecStore&);
+
+  // by position in the live list
+  size_t size() const { return _live.size(); }
+  FecGrp operator [] (size_t pos) { return group(_live[pos]); }
+  unsigned id(size_t pos) const { return _live[pos]; }
+  int& notChange(size_t pos) { return _cls[_live[pos]].notChange; }
+  // returns false if the group at pos is gone; it is replaced by the last
+  // group, or, with keepPos, stays until compact() so positions are kept
+  bool split(size_t pos, bool keepPos = false);
+  void compact();
+  size_t refine(vector<Simtype>& diff);
+
+  // by group id
+  size_t numIds() const { return _cls.size(); }
+  FecGrp group(unsigned id) {
+    if (id >= _cls.size() || _cls[id].begin == _cls[id].end) return FecGrp();
+    return FecGrp(&_mem[_cls[id].begin], _cls[id].end - _cls[id].begin);
+  }
+  bool splitId(unsigned id);
+  bool splitId(unsigned id, const vector<Simtype>& keys, vector<int>& grp);
+  bool refineId(unsigned id, const vector<char>* phase = 0);
+  void erase(unsigned id, size_t j);
+  // an exact group is known to hold equivalent gates only
+  bool exact(unsigned id) const { return _cls[id].exact; }
+  void setExact(unsigned id) { if (_cls[id].begin != _cls[id].end) _cls[id].exact = true; }
+
+  // canonical order: groups by their first member, members by original id
+  bool sorted() const { return _sorted; }
+  void sort();
+  void renumber();
+
+private:
+  struct FecCls
+  {
+    unsigned  begin, end;
+    int       notChange;
+    int       pos;        // in _live; -1 if the group is gone
+    bool      exact;
+  };
+  vector<SimNode>   _mem;
+  vector<FecCls>    _cls;
+  vector<unsigned>  _live;
+  bool              _link;
+  bool              _sorted;
+
+  // (signature, index in the group), sorted to partition a group
+  struct SigRec
+  {
+    Simtype   sig;
+    unsigned  idx;
+    bool operator < (const SigRec& r) const {
+      return (sig != r.sig ? sig < r.sig : idx < r.idx);
+    }
+  };
+  // orders group ids by the id of their first member
+  struct FirstLess
+  {
+    FirstLess(const vector<unsigned>& f) : _f(f) {}
+    bool operator () (unsigned a, unsigned b) const { return _f[a] < _f[b]; }
+    const vector<unsigned>& _f;
+  };
+  // scratch of regroup() and sort()
+  vector<unsigned>  _first;
+  vector<SigRec>    _rec;
+  vector<unsigned>  _run;
+  vector<SimNode>   _buf;
+  vector<Simtype>   _keys;
+
+  bool regroup(unsigned id, bool withKeys = false);
+  void newGroup(unsigned begin, unsigned end);
+};
+
+#endif // CIR_FEC_H
@@ -7,6 +7,9 @@
 ****************************************************************************/
 
 #include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <thread>
 #include "cirMgr.h"
 #include "cirGate.h"
 #include "sat.h"
@@ -26,6 +29,70 @@ using namespace std;
 /**************************************/
 /*   Static varaibles and functions   */
 /**************************************/
+// the fraig solver is rebuilt from the current circuit once this many
+// miters are retired, or once it holds this many learnt clauses
+#define RECYCLE_MITERS  5000
+#define RECYCLE_LEARNTS 100000
+// conflicts per proof over a window
+#define WINDOW_CONFLICTS 100
+// FEC groups per thread in one round of fraigThreads()
+#define THREAD_BATCH    32
+
+// orders the members of an FEC group as fraig() visits them
+struct DfsLess
+{
+  DfsLess(const vector<unsigned>& p) : _p(p) {}
+  bool operator () (const SimNode& a, const SimNode& b) const {
+    return _p[a.second->getId()] < _p[b.second->getId()];
+  }
+  const vector<unsigned>& _p;
+};
+
+// an FEC group proven by a thread of fraigThreads(), with the merges and
+// the pairs proven different it found; the counterexample of diffs[c] is
+// cexLits[cexEnds[c-1], cexEnds[c]), the literals 2 * PI index + value of
+// the PIs in its cones
+struct FraigTask
+{
+  FraigTask(unsigned i) : id(i), byTruth(0), byWindow(0) {}
+  unsigned            id;
+  size_t              byTruth, byWindow;
+  vector<MergeNode>   merges;
+  vector<bool>        phases;
+  vector<MergeNode>   diffs;
+  vector<unsigned>    cexLits;
+  vector<size_t>      cexEnds;
+  vector<MergeNode>   undecided;
+  vector<bool>        undecPhases;
+};
+
+// a pair of fraigSchedule(), with its estimated cost
+struct SchedPair
+{
+  SchedPair(double c, CirGate* a, CirGate* b, bool i) : cost(c), g(a), h(b), inv(i) {}
+  bool operator < (const SchedPair& p) const {
+    return (cost != p.cost ? cost < p.cost : h->getId() < p.h->getId());
+  }
+  double    cost;
+  CirGate*  g;
+  CirGate*  h;
+  bool      inv;
+};
+
+// the estimated cost of proving g against h in a group of n members, by
+// the tree sizes and the 64-bit PI signatures of the supports of the gates
+static double schedCost(const vector<double>& size, const vector<Simtype>& supp,
+                        CirGate* g, CirGate* h, double n) {
+  const Simtype both = supp[g->getId()] & supp[h->getId()];
+  const Simtype any = supp[g->getId()] | supp[h->getId()];
+  const double overlap = (any ? double(__builtin_popcountll(both)) / __builtin_popcountll(any) : 1);
+  const unsigned dl = (g->getLevel() > h->getLevel() ? g->getLevel() - h->getLevel()
+                                                     : h->getLevel() - g->getLevel());
+  return (size[g->getId()] + size[h->getId()] + 1) * (1 + 0.25 * dl)
+         * (2 - overlap) * (1 + 0.1 * log2(n));
+}
+
+static const char* stageStr[3] = { "truth", "window", "sat" };
 
 /*******************************************/
 /*   Public member functions about fraig   */
@@ -53,7 +120,7 @@ CirMgr::strash()
     if (myHash.query(k, g)) { assert(g != NULL);
       merge(g, _dfsList[i], 0);
 
-      cout << "Strashing: " << g->getId() << " merging " << _dfsList[i]->getId() << "..." << endl;
+      cout << "Strashing: " << g->getOrigId() << " merging " << _dfsList[i]->getOrigId() << "..." << endl;
       
       deletelist.push_back(_dfsList[i]->getId());
       if (_dfs_done) _dfs_done = false;
@@ -74,16 +141,23 @@ CirMgr::fraig()
   // createFraigList();
   // SatSolver* solver;
   if (!FECs.size()) return;
-  solver = new SatSolver;
-  solver->initialize();
-  genProofModel(solver);
+  FECsort();
+  const size_t stored = _patStore.size();
+  _ckptCalls = 0;
+  _byTruth = _byWindow = 0;
+  _window.setBudget(WINDOW_CONFLICTS);
+  if (_spec) { fraigSpec(); fraigDone(stored); return; }
+  if (_sched) { fraigSchedule(); fraigDone(stored); return; }
+  if (_threads > 1) { fraigThreads(); fraigDone(stored); return; }
+  _fraigSat.reset(_list.size());
+  _fraigSat.clearAliases();
+  _fraigSat.setBudget(_confBudget);
   
   vector<GateList>         hash;
   vector<vector<bool> >    Inv;
-  vector<vector<char*> >  pattern; // something is wrong
-  hash.resize(FECs.size());
-  Inv.resize(FECs.size());
-  pattern.resize(FECs.size());
+  hash.resize(FECs.numIds());
+  Inv.resize(FECs.numIds());
+  newCexWord();
 
 
   for (size_t i = 0; i < _dfsList.size(); ++i) {
@@ -92,11 +166,12 @@ CirMgr::fraig()
     if (_dfsList[i]->getType() == PO_GATE) continue;
     if (_dfsList[i]->getType() == CONST_GATE) continue;
     if (id == -1) continue;
-    if (!_dfsList[i]->getFec()->size()) continue;
+    FecGrp fec = FECs.group(id);
+    if (!fec.size()) continue;
 
     // cout << '(' << _dfsList[i]->getId() << ')' << endl;
 
-    if (FECs[0][0].second == _list[0] && hash[0].size() == 0) { // insert const0
+    if (FECs.group(0).size() && FECs.group(0)[0].second == _list[0] && hash[0].size() == 0) { // insert const0
       hash[0].push_back(_list[0]);
       Inv[0].push_back(false);
     }
@@ -108,56 +183,60 @@ CirMgr::fraig()
 
     bool simkeyInv;
     int temp = -1;
-    for (size_t j = 0; j < _dfsList[i]->getFec()->size(); ++j) {
-      if (_dfsList[i]->getFec()->at(j).second == _dfsList[i]) {
-        simkeyInv = _dfsList[i]->getFec()->at(j).first.isInv();
+    for (size_t j = 0; j < fec.size(); ++j) {
+      if (fec[j].second == _dfsList[i]) {
+        simkeyInv = fec[j].first.isInv();
         temp = j;
       }
     }
 
     assert(temp != -1);
-    FECs[id].at(temp) = FECs[id].at(FECs[id].size()-1);
-    FECs[id].pop_back();
+    FECs.erase(id, temp);
 
-    bool result;
+    bool result = true;
     if (!hash[id].size() && !Inv[id].size()) {
       hash[id].push_back(_dfsList[i]);
       Inv[id].push_back(simkeyInv);
       continue;
     }
+    else if (FECs.exact(id)) { // proved by exhaustive simulation
+      ToBeMerge.push_back(MergeNode(hash[id][0], _dfsList[i]));
+      mergePhase.push_back(Inv[id][0] != simkeyInv);
+      _fraigSat.alias(_dfsList[i], hash[id][0], Inv[id][0] != simkeyInv);
+      continue;
+    }
     else {
       for (size_t f = 0; f < hash[id].size(); ++f) {
-        if (Inv[id][f] != simkeyInv)
-          result = prove(hash[id][f], 0, _dfsList[i], 1, solver);
-        else
-          result = prove(hash[id][f], 0, _dfsList[i], 0, solver);
-        if (!result) break; // merge
-        if (_dfsList[i]->getFec()->size() > 2) {
-          if (record(result, solver, pattern, id)) {
-            if (FECs[id].size() > 2) {
-              updateBySim(hash, Inv, pattern, id);
-              merge();
-              hash.resize(FECs.size());
-              Inv.resize(FECs.size());
-              pattern.resize(FECs.size());
-            }
+        // proven different before the checkpoint of a loaded session
+        int r = 1;
+        if (!provenDiff(hash[id][f]->getId(), _dfsList[i]->getId())) {
+          r = prove(hash[id][f], _dfsList[i], Inv[id][f] != simkeyInv);
+          if (r == 1) addDiff(hash[id][f]->getId(), _dfsList[i]->getId());
+          if (r == -1) {
+            _undecided.push_back(MergeNode(hash[id][f], _dfsList[i]));
+            _undecPhase.push_back(Inv[id][f] != simkeyInv);
           }
+          ++_ckptCalls;
         }
+        // an undecided pair is kept apart, like a different one
+        result = (r != 0);
+        if (!result) break; // merge
       }
       if (result) {
         hash[id].push_back(_dfsList[i]);
         Inv[id].push_back(simkeyInv);
       }
     }
+    if (_cexCount == 64) resimCex(hash, Inv);
+    if (_fraigSat.retired() >= RECYCLE_MITERS || _fraigSat.nLearnts() >= RECYCLE_LEARNTS)
+      recycleSolver();
+    if (_ckptFile.size() && _ckptCalls >= _ckptEvery) {
+      writeSession(_ckptFile, &hash, &Inv);
+      _ckptCalls = 0;
+    }
   }
 
-  merge();
-  FECs.clear();
-  _dfs_done = false;
-  // DoDfs();
-  _renewfec = true;
-  cout << "Updating by UNSAT... Total #FEC Group = 0" << endl;
-  delete solver; solver = NULL;
+  fraigDone(stored);
 }
 
 /********************************************/
@@ -168,30 +247,547 @@ inline size_t getBucknum(const int& total) {
   return getHashSize(total);
 }
 
-inline bool CirMgr::prove(CirGate* g, bool ginv, CirGate* h, bool hinv, SatSolver*& s) {
-  cout << '\r' << "Proving(" << g->getId() << ", " << h->getId() << ")..." << flush;
-  s->assumeRelease();
-  if (_list[0]->getVar() == -1) _list[0]->setVar(s->newVar());
-  s->assumeProperty(_list[0]->getVar(), false);
+// fraig with _threads threads
+// The FEC groups are proven in rounds of THREAD_BATCH groups per thread,
+// largest first. Every thread takes the groups of the round one by one
+// and proves their members in DFS order against the ones kept so far,
+// with a solver of its own. Nothing in the circuit is written meanwhile:
+// the merges, the pairs proven different and their counterexamples are
+// collected per group and applied here once all threads are done. The
+// counterexamples are simulated 64 at a time and split the groups of the
+// later rounds, as resimCex() does for fraig().
+void CirMgr::fraigThreads() {
+  vector<unsigned> pos;
+  dfsPos(pos);
+
+  vector<char> taken; // the group ids proven or handed to a thread
+  vector<FraigTask> tasks;
+  vector<pair<size_t, unsigned> > bySize;
+  vector<unsigned> order;
+  size_t proven = 0, groups = 0, rounds = 0;
+  newCexWord();
+  while (true) {
+    taken.resize(FECs.numIds(), 0);
+    bySize.clear();
+    for (unsigned id = 0; id < FECs.numIds(); ++id) {
+      FecGrp fec = FECs.group(id);
+      if (taken[id] || fec.size() < 2) continue;
+      if (FECs.exact(id)) { // proved by exhaustive simulation
+        vector<SimNode> m(&fec[0], &fec[0] + fec.size());
+        sort(m.begin(), m.end(), DfsLess(pos));
+        for (size_t j = 1; j < m.size(); ++j) {
+          ToBeMerge.push_back(MergeNode(m[0].second, m[j].second));
+          mergePhase.push_back(m[0].first.isInv() != m[j].first.isInv());
+        }
+        taken[id] = 1;
+        continue;
+      }
+      bySize.push_back(make_pair(fec.size(), id));
+    }
+    if (!bySize.size()) break;
+    // the largest groups first, so that no thread is left with one at the end
+    stable_sort(bySize.begin(), bySize.end(), greater<pair<size_t, unsigned> >());
+    if (bySize.size() > size_t(_threads) * THREAD_BATCH) bySize.resize(_threads * THREAD_BATCH);
+    tasks.clear();
+    order.resize(bySize.size());
+    for (size_t t = 0; t < bySize.size(); ++t) {
+      tasks.push_back(FraigTask(bySize[t].second));
+      taken[bySize[t].second] = 1;
+      order[t] = t;
+    }
+    groups += tasks.size(); ++rounds;
+
+    atomic<size_t> next(0);
+    vector<thread> pool;
+    for (unsigned k = 0; k < _threads; ++k)
+      pool.push_back(thread(&CirMgr::proveTasks, this, ref(tasks), cref(order), ref(next), cref(pos)));
+    for (unsigned k = 0; k < _threads; ++k) pool[k].join();
+
+    for (size_t t = 0; t < tasks.size(); ++t) {
+      const FraigTask& task = tasks[t];
+      for (size_t j = 0; j < task.merges.size(); ++j) {
+        ToBeMerge.push_back(task.merges[j]);
+        mergePhase.push_back(task.phases[j]);
+      }
+      for (size_t j = 0; j < task.diffs.size(); ++j) {
+        addDiff(task.diffs[j].first->getId(), task.diffs[j].second->getId());
+        const Simtype bit = Simtype(1) << _cexCount++;
+        for (size_t l = (j ? task.cexEnds[j - 1] : 0); l < task.cexEnds[j]; ++l) {
+          const unsigned lit = task.cexLits[l];
+          if (lit & 1) _cexWord[lit / 2] |= bit;
+          else _cexWord[lit / 2] &= ~bit;
+        }
+        if (_cexCount == 64) { resimTasks(taken); newCexWord(); }
+      }
+      for (size_t j = 0; j < task.undecided.size(); ++j) {
+        _undecided.push_back(task.undecided[j]);
+        _undecPhase.push_back(task.undecPhases[j]);
+      }
+      proven += task.merges.size() + task.diffs.size() + task.undecided.size();
+      _byTruth += task.byTruth; _byWindow += task.byWindow;
+    }
+    if (_cexCount) { resimTasks(taken); newCexWord(); }
+  }
+  cout << "Proving " << groups << " FEC groups on " << _threads << " threads in "
+       << rounds << " rounds: " << proven << " SAT calls." << endl;
+}
+
+// Simulates the counterexamples of _cexWord and splits the groups that no
+// thread has taken yet; the groups split from them get new ids, which
+// are not taken either.
+void CirMgr::resimTasks(const vector<char>& taken) {
+  for (size_t i = 0; i < _PI.size(); ++i) _PI[i]->setSim(_cexWord[i]);
+  for (size_t i = 0; i < _dfsList.size(); ++i)
+    if (_dfsList[i]->getType() == AIG_GATE) _dfsList[i]->resim();
+  _simValid = true;
+  bool split = false;
+  for (unsigned id = 0, n = taken.size(); id < n; ++id)
+    if (!taken[id] && !FECs.exact(id) && FECs.refineId(id)) split = true;
+  FECs.compact();
+  if (split) recordWord();
+}
+
+// Speculative reduction: every member of an FEC group but the first in
+// DFS order is replaced by that representative for its fanouts, and is
+// proven against it with its own fanins, all in one solver. A member
+// proven this way is equal to its representative only if no miter of the
+// model can be satisfied, so a round with a counterexample proves
+// nothing: the counterexamples (up to 64) are simulated, the groups are
+// refined, and the next round builds the model of the new groups; a
+// member whose counterexample splits nothing leaves its group, so each
+// round makes progress. A miter proven in an earlier round is kept if
+// nothing in its cone of the model has changed since. All merges are
+// done at the end, so a checkpoint between two rounds is just the groups.
+void CirMgr::fraigSpec() {
+  vector<unsigned> pos;
+  dfsPos(pos);
+  vector<CirGateV> rep, last;
+  vector<char> proven(_list.size(), 0), own(_list.size()), read(_list.size());
+  vector<MergeNode> cand, exact;
+  vector<bool> candInv, exactInv;
+  vector<size_t> sat; // the candidates with a counterexample this round
+  vector<SimNode> m;
+  for (unsigned round = 1; ; ++round) {
+    // between rounds, the session is the groups: nothing is merged yet
+    if (round > 1 && _ckptFile.size() && _ckptCalls >= _ckptEvery) {
+      writeSession(_ckptFile, 0, 0);
+      _ckptCalls = 0;
+    }
+    rep.assign(_list.size(), CirGateV());
+    cand.clear(); candInv.clear();
+    exact.clear(); exactInv.clear();
+    for (size_t p = 0; p < FECs.size(); ++p) {
+      FecGrp fec = FECs[p];
+      if (fec.size() < 2) continue;
+      m.assign(&fec[0], &fec[0] + fec.size());
+      sort(m.begin(), m.end(), DfsLess(pos));
+      for (size_t j = 1; j < m.size(); ++j) {
+        const bool inv = (m[0].first.isInv() != m[j].first.isInv());
+        rep[m[j].second->getId()] = CirGateV(m[0].second, inv);
+        if (FECs.exact(FECs.id(p))) { // proved by exhaustive simulation
+          exact.push_back(MergeNode(m[0].second, m[j].second));
+          exactInv.push_back(inv);
+          continue;
+        }
+        cand.push_back(MergeNode(m[0].second, m[j].second));
+        candInv.push_back(inv);
+      }
+    }
+    // own: the function of the gate in the model has changed since the
+    // last round; read: the one its fanouts see (of its representative)
+    last.resize(_list.size());
+    for (size_t i = 0; i < _dfsList.size(); ++i) {
+      CirGate* t = _dfsList[i];
+      if (t->getType() == PO_GATE) continue;
+      const unsigned id = t->getId();
+      own[id] = 0;
+      if (t->getType() == AIG_GATE)
+        own[id] = read[t->getfanin(0).gate()->getId()] | read[t->getfanin(1).gate()->getId()];
+      read[id] = (rep[id]() != last[id]() ||
+                  (rep[id].gate() ? read[rep[id].gate()->getId()] : own[id]));
+    }
+    // in DFS order, so that the cones in the solver grow bottom up
+    vector<pair<unsigned, size_t> > order;
+    size_t kept = 0;
+    for (size_t k = 0; k < cand.size(); ++k) {
+      const unsigned g = cand[k].first->getId(), h = cand[k].second->getId();
+      if (proven[h] && !own[h] && !read[g] && rep[h]() == last[h]()) { ++kept; continue; }
+      proven[h] = 0;
+      order.push_back(make_pair(pos[h], k));
+    }
+    ::sort(order.begin(), order.end());
+    last.swap(rep);
+
+    _fraigSat.reset(_list.size());
+    _fraigSat.setAliases(last);
+    _fraigSat.setBudget(_confBudget);
+    newCexWord();
+    sat.clear();
+    size_t calls = 0, dropped = 0;
+    for (size_t o = 0; o < order.size() && _cexCount < 64; ++o) {
+      const size_t k = order[o].second;
+      CirGate* g = cand[k].first;
+      CirGate* h = cand[k].second;
+      cout << '\r' << "Proving(" << g->getOrigId() << ", " << h->getOrigId() << ")..." << flush;
+      ProveStage by;
+      const int r = decide(_fraigSat, _truth, _window, g, h, candInv[k], by);
+      ++calls;
+      if (by == PROVE_TRUTH) ++_byTruth;
+      if (by == PROVE_WINDOW) ++_byWindow;
+      if (r == 0) proven[h->getId()] = 1;
+      if (r == 1) { record(by == PROVE_TRUTH); sat.push_back(k); }
+      if (_fraigSat.retired() >= RECYCLE_MITERS || _fraigSat.nLearnts() >= RECYCLE_LEARNTS)
+        _fraigSat.reset(_list.size());
+      if (r != -1) continue;
+      // out of budget: h leaves its group, so no other miter relies on it
+      FecGrp fec = FECs.group(h->getFecId());
+      for (size_t j = 0; j < fec.size(); ++j)
+        if (fec[j].second == h) { FECs.erase(h->getFecId(), j); break; }
+      _undecided.push_back(cand[k]);
+      _undecPhase.push_back(candInv[k]);
+      ++dropped;
+    }
+    _ckptCalls += calls;
+    cout << '\r' << "Round " << round << ": " << cand.size() << " candidates, "
+         << kept << " kept, " << calls << " SAT calls, " << _cexCount << " counterexamples, "
+         << dropped << " undecided." << endl;
+    if (!_cexCount && !dropped) break;
+    if (!_cexCount) continue;
+
+    for (size_t i = 0; i < _PI.size(); ++i) _PI[i]->setSim(_cexWord[i]);
+    for (size_t i = 0; i < _dfsList.size(); ++i)
+      if (_dfsList[i]->getType() == AIG_GATE) _dfsList[i]->resim();
+    _simValid = true;
+    bool split = false;
+    for (unsigned id = 0, n = FECs.numIds(); id < n; ++id)
+      if (!FECs.exact(id) && FECs.refineId(id)) split = true;
+    FECs.compact();
+    // a counterexample that simulation does not reproduce splits nothing,
+    // and the next round would find it again: h leaves its group instead
+    for (size_t s = 0; s < sat.size(); ++s) {
+      CirGate* g = cand[sat[s]].first;
+      CirGate* h = cand[sat[s]].second;
+      if (h->getFecId() < 0 || h->getFecId() != g->getFecId()) continue;
+      FecGrp fec = FECs.group(h->getFecId());
+      for (size_t j = 0; j < fec.size(); ++j)
+        if (fec[j].second == h) { FECs.erase(h->getFecId(), j); break; }
+      addDiff(g->getId(), h->getId());
+    }
+    if (!split) continue;
+    recordWord();
+    cout << '\r' << "Updating by SAT... Total #FEC Group = " << FECs.size() << endl;
+  }
+  for (size_t k = 0; k < exact.size(); ++k) {
+    ToBeMerge.push_back(exact[k]);
+    mergePhase.push_back(exactInv[k]);
+  }
+  for (size_t k = 0; k < cand.size(); ++k) {
+    ToBeMerge.push_back(cand[k]);
+    mergePhase.push_back(candInv[k]);
+  }
+}
+
+// Proves the pairs of all FEC groups at once, cheapest first. The cost of
+// a pair grows with the cones of its gates (their sizes counted as trees,
+// so a shared fanin counts twice), their level difference and the size of
+// their group, and shrinks with the overlap of their supports (64-bit
+// signatures of the PIs). The representative of a group is the member of
+// the lowest level with the least total cost of its pairs: no lower
+// member may be in its cone, and since merges only take gates of lower
+// or equal levels, no gate ever reads one of the same level or above.
+// Pairs proven different are simulated with their counterexamples, and
+// the next round takes the refined groups, until a round proves no
+// different pairs; a pair its counterexample does not split gives up its
+// member. Each pair of the order goes to the trace file, and a checkpoint
+// is written between two rounds.
+void CirMgr::fraigSchedule() {
+  vector<double> size(_list.size(), 0);
+  vector<Simtype> supp(_list.size(), 0);
+  for (size_t i = 0; i < _dfsList.size(); ++i) {
+    CirGate* t = _dfsList[i];
+    const unsigned id = t->getId();
+    if (t->getType() == PI_GATE) supp[id] = Simtype(1) << (id % 64);
+    if (t->getType() != AIG_GATE) continue;
+    const unsigned a = t->getfanin(0).gate()->getId(), b = t->getfanin(1).gate()->getId();
+    size[id] = 1 + size[a] + size[b];
+    supp[id] = supp[a] | supp[b];
+  }
+  ofstream trace;
+  if (_traceFile.size()) {
+    trace.open(_traceFile.c_str());
+    if (!trace) cerr << "Cannot open trace file \"" << _traceFile << "\"!!" << endl;
+    else trace << "# round order cost rep member stage result" << endl;
+  }
+
+  _fraigSat.reset(_list.size());
+  _fraigSat.clearAliases();
+  _fraigSat.setBudget(_confBudget);
+  vector<char> done(_list.size(), 0); // merged, or out of budget
+  vector<SchedPair> pairs;
+  vector<size_t> sat; // the pairs proven different this round
+  vector<SimNode> m;
+  for (unsigned round = 1; ; ++round) {
+    // between rounds, the members done leave their groups first, so that
+    // the session has each gate in a pending merge or in a group, not both
+    if (round > 1 && _ckptFile.size() && _ckptCalls >= _ckptEvery) {
+      for (size_t p = 0; p < FECs.size(); ++p) {
+        FecGrp fec = FECs[p];
+        for (size_t j = fec.size(); j--; )
+          if (done[fec[j].second->getId()]) FECs.erase(FECs.id(p), j);
+      }
+      writeSession(_ckptFile, 0, 0);
+      _ckptCalls = 0;
+    }
+    pairs.clear();
+    for (size_t p = 0; p < FECs.size(); ++p) {
+      FecGrp fec = FECs[p];
+      m.clear();
+      for (size_t j = 0; j < fec.size(); ++j)
+        if (!done[fec[j].second->getId()]) m.push_back(fec[j]);
+      if (m.size() < 2) continue;
+      const double n = m.size();
+      unsigned low = m[0].second->getLevel();
+      for (size_t j = 1; j < m.size(); ++j)
+        if (m[j].second->getLevel() < low) low = m[j].second->getLevel();
+      // only the members of the lowest level may represent the group
+      size_t r = m.size();
+      double best = 0;
+      for (size_t j = 0; j < m.size(); ++j) {
+        if (m[j].second->getLevel() != low) continue;
+        double sum = 0;
+        for (size_t k = 0; k < m.size(); ++k)
+          if (k != j) sum += schedCost(size, supp, m[j].second, m[k].second, n);
+        if (r == m.size() || sum < best) { r = j; best = sum; }
+      }
+      const bool exact = FECs.exact(FECs.id(p));
+      for (size_t k = 0; k < m.size(); ++k) {
+        if (k == r) continue;
+        const bool inv = (m[r].first.isInv() != m[k].first.isInv());
+        if (exact) { // proved by exhaustive simulation
+          ToBeMerge.push_back(MergeNode(m[r].second, m[k].second));
+          mergePhase.push_back(inv);
+          _fraigSat.alias(m[k].second, m[r].second, inv);
+          done[m[k].second->getId()] = 1;
+          continue;
+        }
+        pairs.push_back(SchedPair(schedCost(size, supp, m[r].second, m[k].second, n),
+                                  m[r].second, m[k].second, inv));
+      }
+    }
+    ::sort(pairs.begin(), pairs.end());
+
+    newCexWord();
+    sat.clear();
+    size_t calls = 0, merged = 0, diff = 0, o = 0;
+    for (; o < pairs.size() && _cexCount < 64; ++o) {
+      const SchedPair& p = pairs[o];
+      // proven different before the checkpoint of a loaded session: there
+      // is no counterexample to split them by, so h is given up
+      if (provenDiff(p.g->getId(), p.h->getId())) { done[p.h->getId()] = 1; continue; }
+      cout << '\r' << "Proving(" << p.g->getOrigId() << ", " << p.h->getOrigId() << ")..." << flush;
+      ProveStage by;
+      const int r = decide(_fraigSat, _truth, _window, p.g, p.h, p.inv, by);
+      ++calls;
+      if (by == PROVE_TRUTH) ++_byTruth;
+      if (by == PROVE_WINDOW) ++_byWindow;
+      if (trace.is_open())
+        trace << round << ' ' << o << ' ' << p.cost << ' ' << p.g->getOrigId() << ' '
+              << (p.inv ? "!" : "") << p.h->getOrigId() << ' ' << stageStr[by] << ' '
+              << (r == 0 ? "equal" : (r == 1 ? "different" : "undecided")) << endl;
+      if (r == 0) {
+        ToBeMerge.push_back(MergeNode(p.g, p.h));
+        mergePhase.push_back(p.inv);
+        _fraigSat.alias(p.h, p.g, p.inv);
+        done[p.h->getId()] = 1; ++merged;
+      }
+      else if (r == 1) {
+        addDiff(p.g->getId(), p.h->getId()); record(by == PROVE_TRUTH);
+        sat.push_back(o); ++diff;
+      }
+      else {
+        _undecided.push_back(MergeNode(p.g, p.h));
+        _undecPhase.push_back(p.inv);
+        done[p.h->getId()] = 1;
+      }
+      if (_fraigSat.retired() >= RECYCLE_MITERS || _fraigSat.nLearnts() >= RECYCLE_LEARNTS)
+        _fraigSat.reset(_list.size());
+    }
+    _ckptCalls += calls;
+    cout << '\r' << "Round " << round << ": " << pairs.size() << " pairs, " << calls
+         << " proofs, " << merged << " merged, " << diff << " different." << endl;
+    if (!diff) break;
+
+    for (size_t i = 0; i < _PI.size(); ++i) _PI[i]->setSim(_cexWord[i]);
+    for (size_t i = 0; i < _dfsList.size(); ++i)
+      if (_dfsList[i]->getType() == AIG_GATE) _dfsList[i]->resim();
+    _simValid = true;
+    bool split = false;
+    for (unsigned id = 0, n = FECs.numIds(); id < n; ++id)
+      if (!FECs.exact(id) && FECs.refineId(id)) split = true;
+    FECs.compact();
+    // a counterexample that simulation does not reproduce leaves the pair
+    // in one group; h is given up, or the next round would try it again
+    for (size_t s = 0; s < sat.size(); ++s) {
+      const SchedPair& p = pairs[sat[s]];
+      if (p.h->getFecId() >= 0 && p.h->getFecId() == p.g->getFecId()) done[p.h->getId()] = 1;
+    }
+    if (!split) { // every pair above gave up h; the rest of the order is left
+      if (o == pairs.size()) break;
+      continue;
+    }
+    recordWord();
+    cout << '\r' << "Updating by SAT... Total #FEC Group = " << FECs.size() << endl;
+  }
+}
+
+// pos[id] is the place of the gate in _dfsList, from 1; CONST 0 goes first
+void CirMgr::dfsPos(vector<unsigned>& pos) const {
+  pos.assign(_list.size(), 0);
+  for (size_t i = 0; i < _dfsList.size(); ++i)
+    if (_dfsList[i]->getType() != PO_GATE) pos[_dfsList[i]->getId()] = i + 1;
+  pos[0] = 0;
+}
+
+// the body of a thread of fraigThreads()
+void CirMgr::proveTasks(vector<FraigTask>& tasks, const vector<unsigned>& order,
+                        atomic<size_t>& next, const vector<unsigned>& pos) {
+  FraigSolver s;
+  TruthChecker tt;
+  WindowSolver w;
+  w.setBudget(WINDOW_CONFLICTS);
+  s.reset(_list.size());
+  s.setBudget(_confBudget);
+  vector<SimNode> m;
+  vector<SimNode> reps;
+  for (size_t t; (t = next++) < order.size(); ) {
+    FraigTask& task = tasks[order[t]];
+    FecGrp fec = FECs.group(task.id);
+    m.assign(&fec[0], &fec[0] + fec.size());
+    sort(m.begin(), m.end(), DfsLess(pos));
+    reps.clear();
+    for (size_t j = 0; j < m.size(); ++j) {
+      CirGate* h = m[j].second;
+      bool kept = true;
+      for (size_t f = 0; f < reps.size() && kept; ++f) {
+        CirGate* g = reps[f].second;
+        const bool inv = (reps[f].first.isInv() != m[j].first.isInv());
+        if (provenDiff(g->getId(), h->getId())) continue;
+        ProveStage by;
+        const int r = decide(s, tt, w, g, h, inv, by);
+        if (by == PROVE_TRUTH) ++task.byTruth;
+        if (by == PROVE_WINDOW) ++task.byWindow;
+        if (r == 1) {
+          task.diffs.push_back(MergeNode(g, h));
+          for (size_t i = 0; i < _PI.size(); ++i) {
+            const int v = (by == PROVE_TRUTH ? tt.value(_PI[i]) : s.value(_PI[i]));
+            if (v != -1) task.cexLits.push_back(2 * i + v);
+          }
+          task.cexEnds.push_back(task.cexLits.size());
+          continue;
+        }
+        if (r == -1) {
+          task.undecided.push_back(MergeNode(g, h));
+          task.undecPhases.push_back(inv);
+          continue;
+        }
+        task.merges.push_back(MergeNode(g, h));
+        task.phases.push_back(inv);
+        s.alias(h, g, inv);
+        kept = false;
+      }
+      if (kept) reps.push_back(m[j]);
+      if (s.retired() >= RECYCLE_MITERS || s.nLearnts() >= RECYCLE_LEARNTS)
+        s.reset(_list.size());
+    }
+  }
+}
+
+// the merges and the end of fraig(), for both fraig() and fraigThreads()
+void CirMgr::fraigDone(size_t stored) {
+  if (_undecided.size()) retryUndecided();
+  merge();
+  FECs.clear();
+  _diffPairs.clear(); _diffSorted = 0;
+  _dfs_done = false;
+  // DoDfs();
+  _renewfec = true;
+  cout << "Updating by UNSAT... Total #FEC Group = 0" << endl;
+  if (_byTruth || _byWindow)
+    cout << "Truth tables decided " << _byTruth << " pairs, windows proved "
+         << _byWindow << " pairs." << endl;
+  if (_patStore.size() > stored) savePatStore();
+  if (_ckptFile.size()) writeSession(_ckptFile, 0, 0);
+}
+
+// Proves the pairs that ran out of _confBudget conflicts once more with
+// _retryBudget conflicts each, on a solver of the merged circuit, and logs
+// the ones still undecided. A pair is dropped if one of its gates is
+// merged away meanwhile: the gate that took its place was proven equal
+// to it, and is compared with the other one in its own pair if at all.
+void CirMgr::retryUndecided() {
+  merge();
+  vector<bool> gone(_list.size(), false);
+  if (_retryBudget >= 0) {
+    _fraigSat.reset(_list.size());
+    _fraigSat.clearAliases();
+    _fraigSat.setBudget(_retryBudget);
+  }
+  size_t left = 0;
+  for (size_t k = 0; k < _undecided.size(); ++k) {
+    CirGate* g = _undecided[k].first;
+    CirGate* h = _undecided[k].second;
+    if (_list[g->getId()] != g || _list[h->getId()] != h) continue;
+    if (gone[g->getId()] || gone[h->getId()]) continue;
+    const int r = (_retryBudget >= 0 ? prove(g, h, _undecPhase[k]) : -1);
+    if (r == 0) gone[h->getId()] = true;
+    if (r != -1) continue;
+    cout << '\r' << "Undecided(" << g->getOrigId() << ", " << (_undecPhase[k] ? "!" : "")
+         << h->getOrigId() << ")" << endl;
+    ++left;
+  }
+  cout << '\r' << left << " of " << _undecided.size() << " pairs left undecided within "
+       << _confBudget << " conflicts";
+  if (_retryBudget >= 0) cout << " (" << _retryBudget << " in the retry)";
+  cout << "." << endl;
+  _undecided.clear(); _undecPhase.clear();
+}
 
-  Var newV = s->newVar();
-  s->addXorCNF(newV, g->getVar(), ginv, h->getVar(), hinv);
-  s->assumeProperty(newV, true);
-  bool result = s->assumpSolve();
+inline int CirMgr::prove(CirGate* g, CirGate* h, bool inv) {
+  cout << '\r' << "Proving(" << g->getOrigId() << ", " << h->getOrigId() << ")..." << flush;
+  ProveStage by;
+  const int result = decide(_fraigSat, _truth, _window, g, h, inv, by);
+  if (by == PROVE_TRUTH) ++_byTruth;
+  if (by == PROVE_WINDOW) ++_byWindow;
   if (!result) {
     ToBeMerge.push_back(MergeNode(g, h));
-    mergePhase.push_back(hinv);
+    mergePhase.push_back(inv);
+    _fraigSat.alias(h, g, inv);
   }
+  if (result == 1) record(by == PROVE_TRUTH);
   return result;
 }
 
+// g and h (inverted if inv) by their truth tables if their support is
+// small, then over a window of their cones, and at last by s with their
+// full cones; by tells the stage that decided. Returns as prove().
+inline int CirMgr::decide(FraigSolver& s, TruthChecker& tt, WindowSolver& w,
+                          CirGate* g, CirGate* h, bool inv, ProveStage& by) {
+  int result = tt.check(g, h, inv);
+  by = PROVE_TRUTH;
+  if (result != -1) return result;
+  by = PROVE_WINDOW;
+  if (w.prove(g, h, inv) == 0) return 0;
+  by = PROVE_SAT;
+  return s.prove(g, h, inv);
+}
+
 void CirMgr::merge() {
   assert(ToBeMerge.size() == mergePhase.size());
   for (size_t i = 0; i < ToBeMerge.size(); ++i) {
     merge(ToBeMerge[i].first, ToBeMerge[i].second, mergePhase[i]);
-    cout << '\r' << "Fraig: " << ToBeMerge[i].first->getId() << " merging ";
+    cout << '\r' << "Fraig: " << ToBeMerge[i].first->getOrigId() << " merging ";
     if (mergePhase[i]) cout << '!';
-    cout << ToBeMerge[i].second->getId() << "..." << endl;
+    cout << ToBeMerge[i].second->getOrigId() << "..." << endl;
     // delete _list[ToBeMerge[i].second->getId()];
     _list[ToBeMerge[i].second->getId()] = 0; --_ANDnum;
   }
@@ -207,98 +803,99 @@ void CirMgr::merge(CirGate* g, CirGate* h, int check = 2) { // g merges h, which
 
   VList h_out = h->getOutList();
   for (size_t i = 0; i < h_out.size(); ++i) {
+    // each fanout edge replaces the one fanin it stands for; a gate reading
+    // h twice, maybe in both phases, has an edge for each
+    const bool inv = h_out[i].isInv();
     if (check) h_out[i].changePhase();
     g->setfanout(h_out[i]);
     for (int u = 0; u < 2; ++u) {
-      if (h_out[i].gate()->getfanin(u).gate() != h) continue;
+      const CirGateV in = h_out[i].gate()->getfanin(u);
+      if (in.gate() != h || in.isInv() != inv) continue;
       h_out[i].gate()->replaceFanin(u, g, h_out[i].isInv());
+      break;
     }
   }
+  // one fanout edge of a fanin per fanin edge of h; the list is read in
+  // place, as a copy per edge is quadratic in the fanouts of the fanin
   for (int id = 0; id < 2; ++id) {
-    for (int i = 0; i < h->getfanin(id).gate()->getOutList().size(); ++i) {
-      if (h->getfanin(id).gate()->getOutList()[i].gate() != h) continue;
-      h->getfanin(id).gate()->RemoveFanout(i);
+    CirGate* f = h->getfanin(id).gate();
+    for (size_t i = 0, n = f->fanoutNO(); i < n; ++i) {
+      if (f->getfanout(i).gate() != h) continue;
+      f->RemoveFanout(i);
+      break;
     }
   }
 }
 
-inline bool CirMgr::record(const bool& result, SatSolver*& s, vector<vector<char*> >& pat, const size_t& id) {
-  if (!result) return false;
-  // stringstream ss;
-  char* sim = new char[_PI.size()];
-  for (size_t i = 0; i < _PI.size(); ++i) {
-    Var var = _PI[i]->getVar();
-    if (var == -1)
-      sim[i] = '0';
-      // ss << 0;
-    else
-      sim[i] = var + '0';
-      // ss << (s->getValue(var));
-  }
-  // pat[id].push_back(ss.str());
-  pat[id].push_back(sim);
-  if (pat[id].size() > 255) return true;
-  else return false;
+// a word of random PI values, whose bits are replaced by counterexamples
+inline void CirMgr::newCexWord() {
+  _cexWord.resize(_PI.size());
+  for (size_t i = 0; i < _PI.size(); ++i)
+    _cexWord[i] = (Simtype(rnGen(INT_MAX)) << 32) ^ rnGen(INT_MAX);
+  _cexCount = 0;
 }
 
-inline void CirMgr::initVar() {
-  for (size_t i = 0; i < _list.size(); ++i) {
-    if (_list[i] == NULL) continue;
-    if (_list[i]->getType() != AIG_GATE || _list[i]->getType() != PI_GATE) continue;
-    _list[i]->setVar(-1);
+// Takes the PI values of the model of the last SAT call (or of the
+// pattern of the last truth-table check) as the next bit of _cexWord; the
+// PIs outside the cones in the solver keep their random bit.
+inline void CirMgr::record(bool byTruth) {
+  if (_cexCount == 64) return;
+  const Simtype bit = Simtype(1) << _cexCount++;
+  for (size_t i = 0; i < _PI.size(); ++i) {
+    const int v = (byTruth ? _truth.value(_PI[i]) : _fraigSat.value(_PI[i]));
+    if (v == 1) _cexWord[i] |= bit;
+    else if (v == 0) _cexWord[i] &= ~bit;
   }
 }
 
-inline void CirMgr::updateBySim(vector<GateList>& hash, vector<vector<bool> >& Inv, vector<vector<char*> >& pat, const int& id) {
-  // assert(pat[id][0].size() == _PI.size());
-  int top = pat[id].size() / 64;
-  while (top > 0) {
+// Drops the retired miters, the learnt clauses and the cones of the
+// merged gates; the cones are encoded again as prove() needs them.
+inline void CirMgr::recycleSolver() {
+  merge();
+  _fraigSat.reset(_list.size());
+}
 
-  for (size_t i = 0; i < _PI.size(); ++i) {
-    Simtype s = Simtype(0);
-    for (size_t j = (top-1)*64; j < top*64; ++j) {
-      s << 1;
-      s += Simtype(pat[id][j][i] - '0');
+// Simulates the 64 counterexamples of _cexWord at once and splits every
+// FEC group by them, not only the ones they came from. The members fraig
+// keeps in hash are no longer in their groups, so they are split along:
+// each goes to the part it simulates with, with its phase in this word.
+void CirMgr::resimCex(vector<GateList>& hash, vector<vector<bool> >& Inv) {
+  for (size_t i = 0; i < _PI.size(); ++i) _PI[i]->setSim(_cexWord[i]);
+  for (size_t i = 0; i < _dfsList.size(); ++i)
+    if (_dfsList[i]->getType() == AIG_GATE) _dfsList[i]->resim();
+  _simValid = true;
+
+  bool split = false;
+  vector<Simtype> keys;
+  vector<int> grp;
+  GateList reps;
+  for (unsigned id = 0, n = FECs.numIds(); id < n; ++id) {
+    FecGrp fec = FECs.group(id);
+    if (!fec.size() || FECs.exact(id)) continue;
+    for (size_t j = 0; j < fec.size(); ++j) fec[j].first.update(fec[j].second->value());
+    reps.swap(hash[id]); hash[id].clear(); Inv[id].clear();
+    keys.resize(reps.size());
+    for (size_t f = 0; f < reps.size(); ++f) {
+      SimKey k(0); k.update(reps[f]->value());
+      keys[f] = k();
     }
-    _PI[i]->setSim(s);
-  }
-  
-  // pat[id].clear();
-  for (size_t i = 0; i < pat[id].size(); ++i) {
-    delete pat[id][i];
-  } pat[id].clear();
-
-  HashMap<SimKey, CirGate*> newGrps(getHashSize(FECs[id].size()));
-  for (size_t i = 0; i < FECs[id].size(); ++i) {
-    CirGate::setGlobalRef();
-    Simtype value = FECs[id][i].second->sim();
-    FECs[id][i].first.update(value);
-    newGrps.insert(FECs[id][i]);
-  }
-  // for (size_t i = 0; i < hash[id].size(); ++i) {
-  //   CirGate::setGlobalRef();
-  //   Simtype value = hash[id][i]->sim();
-  //   SimNode node(SimKey(value), hash[id][i]);
-  //   newGrps.insert(node);
-  //   hash[id].clear(); Inv[id].clear();
-  // }
-  vector<FEC> valid; newGrps.valid(valid);
-  if (valid.size() == 1) {  if (top > 0) {--top; continue;} else return; }
-  FEC check = FECs[id];
-  FECs[id] = valid[0];
-  for (size_t i = 1; i < valid.size(); ++i) {
-    int fecid = FECs.size();
-    FECs.push_back(valid[i]);
-    assert(valid[i].size() > 1);
-    for (size_t f = 0; f < valid[i].size(); ++f) {
-      FEC* t = &FECs[fecid];
-      valid[i][f].second->setFec(t ,fecid);
+    const size_t before = FECs.numIds(), size = fec.size();
+    FECs.splitId(id, keys, grp);
+    if (FECs.numIds() != before || FECs.group(id).size() != size) split = true;
+    hash.resize(FECs.numIds());
+    Inv.resize(FECs.numIds());
+    for (size_t f = 0; f < reps.size(); ++f) {
+      if (grp[f] < 0) continue;
+      hash[grp[f]].push_back(reps[f]);
+      Inv[grp[f]].push_back(~reps[f]->value() < reps[f]->value());
     }
   }
-  cout << '\r' << "Updating by SAT... Total #FEC Group = " << FECs.size() << endl;
-
-  --top;
+  FECs.compact();
+  if (split) {
+    recordWord();
+    cout << '\r' << "Updating by SAT... Total #FEC Group = " << FECs.size() << endl;
   }
+  newCexWord();
 }
 
 void CirMgr::reportResult(const SatSolver& solver, bool result)
@@ -311,22 +908,3 @@ void CirMgr::reportResult(const SatSolver& solver, bool result)
    }
 }
 
-void CirMgr::genProofModel(SatSolver*& s) { // recusively generate model from po
-  for (size_t i = 0; i < _dfsList.size(); ++i) {
-    if (_dfsList[i]->getType() == PI_GATE) {
-      Var v = s->newVar();
-      _dfsList[i]->setVar(v);
-    }
-    else if (_dfsList[i]->getType() == CONST_GATE) {
-      Var v = s->newVar();
-      _dfsList[i]->setVar(v);
-    }
-    else if (_dfsList[i]->getType() == AIG_GATE) {
-      Var v = s->newVar();
-      CirGateV v0 = _dfsList[i]->getfanin(0);
-      CirGateV v1 = _dfsList[i]->getfanin(1);
-      _dfsList[i]->setVar(v);
-      s->addAigCNF(v, v0.gate()->getVar(), v0.isInv(), v1.gate()->getVar(), v1.isInv());
-    }
-  }
-}
\ No newline at end of file
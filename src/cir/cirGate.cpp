@@ -30,7 +30,7 @@ void
 PIGate::reportGate() const
 {
   stringstream ss, value;
-  ss << "= " << getTypeStr() << '(' << _id << ')';
+  ss << "= " << getTypeStr() << '(' << getOrigId() << ')';
   if (_name != "") ss << "\"" << _name << "\"";
   ss << ", line " << _line;
   Simtype token = _value;
@@ -49,7 +49,7 @@ void
 POGate::reportGate() const
 {
   stringstream ss, value;
-  ss << "= " << getTypeStr() << '(' << _id << ')';
+  ss << "= " << getTypeStr() << '(' << getOrigId() << ')';
   if (_name != "") ss << "\"" << _name << "\"";
   ss << ", line " << _line;
   Simtype token = _value;
@@ -68,7 +68,7 @@ void
 AIGGate::reportGate() const
 {
   stringstream ss, value;
-  ss << "= " << getTypeStr() << '(' << _id << ')';
+  ss << "= " << getTypeStr() << '(' << getOrigId() << ')';
   ss << ", line " << _line;
   Simtype token = _value;
   for (int i = 1; i <= 64; ++i) {
@@ -87,7 +87,7 @@ void
 CONSTGate::reportGate() const
 {
   stringstream ss;
-  ss << "= " << getTypeStr() << '(' << _id << ')';
+  ss << "= " << getTypeStr() << '(' << getOrigId() << ')';
   ss << ", line " << _line;
   cout << "================================================================================" << endl;
   cout << ss.str() << endl;
@@ -100,7 +100,7 @@ void
 UNDEFGate::reportGate() const
 {
   stringstream ss;
-  ss << "= " << getTypeStr() << '(' << _id << ')';
+  ss << "= " << getTypeStr() << '(' << getOrigId() << ')';
   ss << ", line " << _line;
   cout << "================================================================================" << endl;
   cout << ss.str() << endl;
@@ -110,27 +110,28 @@ UNDEFGate::reportGate() const
 }
 
 void CirGate::printFEC() const {
-  if (_fec == NULL) {
+  FecGrp fec = cirMgr->getFecGrp(this);
+  if (!fec.size()) {
     cout << endl;
     return;
   }
   bool check = false;
-  for (size_t i = 0; i < _fec->size(); ++i) {
-    if (_fec->at(i).second != this) continue;
-    check = _fec->at(i).first.isInv();
+  for (size_t i = 0; i < fec.size(); ++i) {
+    if (fec[i].second != this) continue;
+    check = fec[i].first.isInv();
     break;
   }
-  for (size_t i = 0; i < _fec->size(); ++i) {
-    if (_fec->at(i).second == this) continue;
+  for (size_t i = 0; i < fec.size(); ++i) {
+    if (fec[i].second == this) continue;
 
     if (!check) {
       cout << ' ';
-      if (_fec->at(i).first.isInv()) cout << '!';
-      cout << _fec->at(i).second->getId();
+      if (fec[i].first.isInv()) cout << '!';
+      cout << fec[i].second->getOrigId();
     } else {
       cout << ' ';
-      if (!_fec->at(i).first.isInv()) cout << '!';
-      cout << _fec->at(i).second->getId();
+      if (!fec[i].first.isInv()) cout << '!';
+      cout << fec[i].second->getOrigId();
     }
 
   }
@@ -142,7 +143,7 @@ void reportin (string t, VList& n, int level) {
   for (size_t i = 0; i < n.size(); i++) {
     cout << t;
     if (n[i].isInv()) cout << '!';
-    cout << n[i].gate()->getTypeStr() << ' ' << n[i].gate()->getId();
+    cout << n[i].gate()->getTypeStr() << ' ' << n[i].gate()->getOrigId();
 
     if (n[i].gate()->isGlobalRef()) {
       cout << " (*)" << endl;
@@ -164,7 +165,7 @@ CirGate::reportFanin(int level)
    assert (level >= 0);
    CirGate::setGlobalRef();
    VList n = getInList();
-   cout << getTypeStr() << ' ' << getId() << endl;
+   cout << getTypeStr() << ' ' << getOrigId() << endl;
    --level;
    setToGlobalRef();
    reportin("  ", n, level);
@@ -175,7 +176,7 @@ void reportout (string t, VList& n, int level) {
   for (size_t i = 0; i < n.size(); i++) {
     cout << t;
     if (n[i].isInv()) cout << '!';
-    cout << n[i].gate()->getTypeStr() << ' ' << n[i].gate()->getId();
+    cout << n[i].gate()->getTypeStr() << ' ' << n[i].gate()->getOrigId();
 
     if (n[i].gate()->isGlobalRef() && level > 0) {
       cout << " (*)" << endl;
@@ -197,7 +198,7 @@ CirGate::reportFanout(int level)
    assert (level >= 0);
    CirGate::setGlobalRef();
    VList o = getOutList();
-   cout << getTypeStr() << ' ' << getId() << endl;
+   cout << getTypeStr() << ' ' << getOrigId() << endl;
    --level;
    setToGlobalRef();
 
@@ -54,13 +54,16 @@ class CirGate
    unsigned _ref;
 
 public:
-   CirGate() : _ref(0), in_dfs(false), _value(0), _var(-1), _fec(NULL), _fecid(-1) {}
+   CirGate() : _ref(0), in_dfs(false), _value(0), _var(-1), _level(0), _fecid(-1), _orig(unsigned(-1)) {}
    virtual ~CirGate() {}
 
    // Basic access methods
    bool InDfs() { return in_dfs; }
    unsigned getLineNo() const { return _line; }
    unsigned getId() const { return _id; }
+   // the id in the circuit file; it differs from getId() after
+   // CirMgr::reorder(), and is the one to report and to write
+   unsigned getOrigId() const { return (_orig == unsigned(-1) ? _id : _orig); }
    Simtype value() const { return _value; }
    virtual GateType getType() const = 0;
    virtual string getTypeStr() const = 0;
@@ -87,6 +90,7 @@ public:
    virtual void RemoveFanin(int i) { return; }
    virtual void setname(const string& str) { return; }
    void setid(const unsigned& id) { _id = id; }
+   void setOrigId(const unsigned& id) { _orig = id; }
    void setline(const unsigned& l) { _line = l; }
 
    // for DFS
@@ -97,15 +101,23 @@ public:
    static void setGlobalRef() { ++_globalRef; }
 
    // for simulation
-   void setFec(FEC*& c, unsigned i) { _fec = c; _fecid = i; }
-   void resetFEC() { _fec = NULL; _fecid = -1; }
-   FEC* getFec() const { return _fec; }
+   // _fecid is the id of the FEC group in CirMgr's FecStore
+   void setFec(unsigned i) { _fecid = i; }
+   void resetFEC() { _fecid = -1; }
    int getFecId() const { return _fecid; }
    void printFEC() const;
    virtual Simtype sim() { return Simtype(0); }
    virtual void setSim(const Simtype& sim) { return; }
+   void setValue(const Simtype& v) { _value = v; }
    virtual void FindIn(vector<unsigned>& inlist) { return; }
 
+   // for event-driven simulation
+   // resim() re-evaluates the gate from the current values of its fanins
+   // and returns true if its value has changed
+   unsigned getLevel() const { return _level; }
+   void setLevel(const unsigned& l) { _level = l; }
+   virtual bool resim() { return false; }
+
    // other
    virtual bool isAig() const { return false; }
 
@@ -119,10 +131,11 @@ protected:
    unsigned     _line;
    Var          _var;
    Simtype      _value;
+   unsigned     _level;
 private:
    mutable bool in_dfs;
-   FEC*         _fec;
    int          _fecid;
+   unsigned     _orig;
 };
 
 class PIGate : public CirGate
@@ -132,7 +145,7 @@ public:
   ~PIGate() {}
   void reportGate() const;
   void printGate() const {
-    cout << setw(4) << left << getTypeStr() << _id;
+    cout << setw(4) << left << getTypeStr() << getOrigId();
     if (_name != "") cout << " (" << _name << ')';
   }
   void setfanout(CirGateV& out) { _fanout.push_back(out); }
@@ -171,10 +184,10 @@ public:
   ~POGate() {}
   void reportGate() const;
   void printGate() const {
-    cout << setw(4) << left << getTypeStr() << _id << ' ';
+    cout << setw(4) << left << getTypeStr() << getOrigId() << ' ';
     if (_fanin.gate()->getType() == UNDEF_GATE) cout << "*";
     if (_fanin.isInv()) cout << '!';
-    cout << _fanin.gate()->getId();
+    cout << _fanin.gate()->getOrigId();
     if (_name != "") cout << " (" << _name << ')';
   }
   void setfanin(CirGateV& in) { _fanin = in; }
@@ -191,6 +204,12 @@ public:
       return _value;
     }
   }
+  bool resim() {
+    Simtype v = _fanin.gate()->value();
+    if (_fanin.isInv()) v = ~v;
+    if (v == _value) return false;
+    _value = v; return true;
+  }
   size_t faninNO() { return 1; }
   CirGateV getfanin(int i = 0) const { return _fanin; }
   VList getInList() const { VList n; n.push_back(_fanin); return n;}
@@ -211,15 +230,15 @@ public:
   void reportGate() const;
   void reset() { _fanin0.replaceGate(0); _fanin1.replaceGate(0); }
   void printGate() const {
-    cout << setw(4) << left << getTypeStr() << _id;
+    cout << setw(4) << left << getTypeStr() << getOrigId();
     cout << ' ';
     if (_fanin0.gate()->getType() == UNDEF_GATE) cout << "*";
     if (_fanin0.isInv()) cout << '!';
-    cout << _fanin0.gate()->getId();
+    cout << _fanin0.gate()->getOrigId();
     cout << ' ';
     if (_fanin1.gate()->getType() == UNDEF_GATE) cout << "*";
     if (_fanin1.isInv()) cout << '!';
-    cout << _fanin1.gate()->getId();
+    cout << _fanin1.gate()->getOrigId();
   }
   void setfanin(CirGateV& in) { 
     if (_fanin0.gate() == NULL) _fanin0 = in;
@@ -266,6 +285,15 @@ public:
     _value = (right & left);
     return _value;
   }
+  bool resim() {
+    Simtype right = _fanin0.gate()->value();
+    if (_fanin0.isInv()) right = (~right);
+    Simtype left = _fanin1.gate()->value();
+    if (_fanin1.isInv()) left = (~left);
+    if ((right & left) == _value) return false;
+    _value = (right & left);
+    return true;
+  }
   void FindIn(vector<unsigned>& inlist) {
     if (isGlobalRef()) return;
     _fanin0.gate()->FindIn(inlist);
@@ -348,7 +376,7 @@ public:
    CirGateV getfanout(int i) const { if (_fanout.size() == 0) return CirGateV(0, 0); return _fanout[i];}
    VList getOutList() const { return _fanout; }
 
-   void printGate() const { cout << setw(4) << left << "UNDEF" << _id; }
+   void printGate() const { cout << setw(4) << left << "UNDEF" << getOrigId(); }
    void setfanout(CirGateV& out) { _fanout.push_back(out); }
    void RemoveFanout(int i) {
      VList::iterator it = _fanout.begin(); it += i;
@@ -0,0 +1,245 @@
+/****************************************************************************
+  FileName     [ cirImage.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define the memory-mapped circuit image ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "cirImage.h"
+#include "cirMgr.h"
+#include "cirGate.h"
+
+using namespace std;
+
+/*******************************/
+/*   Global variable and enum  */
+/*******************************/
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+static const char imgMagic[8] = { 'C', 'I', 'R', 'I', 'M', 'A', 'G', 'E' };
+#define IMG_VERSION 1
+
+static inline size_t align8(size_t n) { return (n + 7) & ~size_t(7); }
+
+static bool imgError(const string& name) {
+  cerr << "Error: circuit image \"" << name << "\" is corrupted!!" << endl;
+  return false;
+}
+
+/**************************************/
+/*   class CirImage member functions  */
+/**************************************/
+size_t CirImage::layout(const CirImageHeader& h, size_t* off) {
+  const size_t M = h.maxVar, I = h.nPI, O = h.nPO, A = h.nAnd;
+  const size_t bytes[SECTIONS] = {
+    M + 1, 2 * (M + 1) * 4, (M + 1 + O) * 4, I * 4, O * 4, A * 4, A * 4,
+    (I + O + 2) * 4, h.nameBytes };
+  size_t at = align8(sizeof(CirImageHeader));
+  for (int s = 0; s < SECTIONS; ++s) { off[s] = at; at = align8(at + bytes[s]); }
+  return at;
+}
+
+// maps the whole file; nothing is read or copied until it is used
+bool CirImage::open(const string& name) {
+  close();
+  int fd = ::open(name.c_str(), O_RDONLY);
+  if (fd < 0) { cout << "Cannot open image \"" << name << "\"!!" << endl; return false; }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(CirImageHeader)) {
+    ::close(fd);
+    cerr << "Error: \"" << name << "\" is not a circuit image!!" << endl;
+    return false;
+  }
+  void* p = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (p == MAP_FAILED) { cerr << "Error: cannot map \"" << name << "\"!!" << endl; return false; }
+  _base = (char*)p; _size = st.st_size;
+  _h = (const CirImageHeader*)_base;
+  if (memcmp(_h->magic, imgMagic, 8) != 0 || _h->version != IMG_VERSION) {
+    close();
+    cerr << "Error: \"" << name << "\" is not a circuit image!!" << endl;
+    return false;
+  }
+  size_t off[SECTIONS];
+  if (layout(*_h, off) != _size) { close(); return imgError(name); }
+  _type = (const unsigned char*)(_base + off[TYPE]);
+  _fanin = (const unsigned*)(_base + off[FANIN]);
+  _line = (const unsigned*)(_base + off[LINE]);
+  _pi = (const unsigned*)(_base + off[PI]);
+  _po = (const unsigned*)(_base + off[PO]);
+  _order = (const unsigned*)(_base + off[ORDER]);
+  _topo = (const unsigned*)(_base + off[TOPO]);
+  _nameOff = (const unsigned*)(_base + off[NAMEOFF]);
+  _names = _base + off[NAMES];
+  for (unsigned k = 0; k <= numPIs() + numPOs(); ++k)
+    if (_nameOff[k] > _nameOff[k+1] || _nameOff[k+1] > _h->nameBytes) {
+      close(); return imgError(name);
+    }
+  return true;
+}
+
+void CirImage::close() {
+  if (_base) munmap(_base, _size);
+  _base = 0; _size = 0;
+}
+
+/**************************************************/
+/*   class CirMgr member functions about images   */
+/**************************************************/
+// Builds the gates from the mapped arrays; there is no text to parse, so
+// the time is spent on allocating the gates only. Nothing reads the image
+// once the gates are built, so it is unmapped on return.
+bool CirMgr::readImage(const string& name) {
+  CirImage img;
+  if (!img.open(name)) return false;
+  const unsigned M = img.maxVar(), I = img.numPIs(), O = img.numPOs(), A = img.numAnds();
+  _fileName = name;
+  _MaxVarnum = M; _PInum = I; _Latchnum = img.numLatches(); _POnum = O; _ANDnum = A;
+  _list.resize(M + 1);
+  _list[0] = new CONSTGate(0, 0);
+  for (unsigned i = 0; i < I; ++i) {
+    const unsigned id = img.pi(i);
+    if (!id || id > M || _list[id] || img.type(id) != PI_GATE) return imgError(name);
+    int l = 2 * id;
+    setGate(img.line(id), l, PI_GATE);
+  }
+  for (unsigned i = 0; i < O; ++i) {
+    if (img.po(i) / 2 > M) return imgError(name);
+    int l = img.po(i);
+    setGate(img.poLine(i), l, PO_GATE);
+  }
+  for (unsigned k = 0; k < A; ++k) {
+    const unsigned id = img.order(k);
+    if (!id || id > M || _list[id] || img.type(id) != AIG_GATE) return imgError(name);
+    if (img.fanin(id, 0) / 2 > M || img.fanin(id, 1) / 2 > M) return imgError(name);
+    int l = 2 * id;
+    setGate(img.line(id), l, AIG_GATE);
+  }
+  for (unsigned k = 0; k < A; ++k) {
+    const unsigned id = img.order(k);
+    setinput(img.fanin(id, 0), _list[id]);
+    setinput(img.fanin(id, 1), _list[id]);
+  }
+  for (unsigned i = 0; i < I + O; ++i) {
+    const string s = img.name(i);
+    if (s.size()) (i < I ? _PI[i] : _PO[i - I])->setname(s);
+  }
+  const string c = img.name(I + O);
+  for (size_t b = 0, e; b < c.size(); b = e + 1) {
+    e = c.find('\n', b);
+    if (e == string::npos) e = c.size();
+    comment.push_back(c.substr(b, e - b));
+  }
+  connect();
+  DoDfs();
+  return true;
+}
+
+bool CirMgr::writeImage(const string& name) const {
+  CirImageHeader h;
+  memcpy(h.magic, imgMagic, 8);
+  h.version = IMG_VERSION;
+  h.maxVar = _MaxVarnum; h.nPI = _PI.size(); h.nLatch = _Latchnum; h.nPO = _PO.size();
+  const size_t M = _MaxVarnum, I = _PI.size(), O = _PO.size();
+
+  vector<unsigned char> type(M + 1, IMG_NO_GATE);
+  vector<unsigned> fanin(2 * (M + 1), 0), line(M + 1 + O, 0), pi(I), po(O);
+  vector<pair<unsigned, unsigned> > byLine; // (line, id)
+  for (size_t i = 0; i <= M; ++i) {
+    if (!_list[i]) continue;
+    type[i] = _list[i]->getType();
+    line[i] = _list[i]->getLineNo();
+    if (type[i] != AIG_GATE) continue;
+    for (int k = 0; k < 2; ++k) {
+      const CirGateV in = _list[i]->getfanin(k);
+      fanin[2*i + k] = 2 * in.gate()->getId() + in.isInv();
+    }
+    byLine.push_back(make_pair(line[i], unsigned(i)));
+  }
+  sort(byLine.begin(), byLine.end());
+  vector<unsigned> order(byLine.size());
+  for (size_t k = 0; k < order.size(); ++k) order[k] = byLine[k].second;
+  h.nAnd = order.size();
+  for (size_t i = 0; i < I; ++i) pi[i] = _PI[i]->getId();
+  for (size_t i = 0; i < O; ++i) {
+    const CirGateV in = _PO[i]->getfanin();
+    po[i] = 2 * in.gate()->getId() + in.isInv();
+    line[M + 1 + i] = _PO[i]->getLineNo();
+  }
+
+  // topological order of all AIG gates, also the ones no PO reaches
+  vector<unsigned> topo;
+  vector<pair<CirGate*, int> > stack;
+  CirGate::setGlobalRef();
+  for (size_t k = 0; k < order.size(); ++k) {
+    CirGate* g = _list[order[k]];
+    if (g->isGlobalRef()) continue;
+    g->setToGlobalRef();
+    stack.push_back(make_pair(g, 0));
+    while (stack.size()) {
+      CirGate* t = stack.back().first;
+      if (stack.back().second == 2) {
+        topo.push_back(t->getId()); stack.pop_back(); continue;
+      }
+      CirGate* f = t->getfanin(stack.back().second++).gate();
+      if (f->getType() != AIG_GATE || f->isGlobalRef()) continue;
+      f->setToGlobalRef();
+      stack.push_back(make_pair(f, 0));
+    }
+  }
+
+  // names of the PIs and POs, then the comment lines
+  string names;
+  vector<unsigned> nameOff(I + O + 2, 0);
+  for (size_t i = 0; i < I + O; ++i) {
+    names += (i < I ? _PI[i] : _PO[i - I])->getName();
+    nameOff[i + 1] = names.size();
+  }
+  for (size_t i = 0; i < comment.size(); ++i) {
+    if (i) names += '\n';
+    names += comment[i];
+  }
+  nameOff[I + O + 1] = names.size();
+  h.nameBytes = names.size();
+
+  size_t off[CirImage::SECTIONS];
+  const size_t total = CirImage::layout(h, off);
+  const string tmp = name + ".tmp";
+  ofstream out(tmp.c_str(), ios::out | ios::binary);
+  if (!out) { cerr << "Cannot open \"" << tmp << "\"!!" << endl; return false; }
+  const void* data[CirImage::SECTIONS] = {
+    type.data(), fanin.data(), line.data(), pi.data(), po.data(),
+    order.data(), topo.data(), nameOff.data(), names.data() };
+  const size_t bytes[CirImage::SECTIONS] = {
+    type.size(), fanin.size() * 4, line.size() * 4, I * 4, O * 4,
+    order.size() * 4, topo.size() * 4, nameOff.size() * 4, names.size() };
+  static const char pad[8] = { 0 };
+  out.write((const char*)&h, sizeof(h));
+  size_t at = sizeof(h);
+  for (int s = 0; s < CirImage::SECTIONS; ++s) {
+    out.write(pad, off[s] - at);
+    if (bytes[s]) out.write((const char*)data[s], bytes[s]);
+    at = off[s] + bytes[s];
+  }
+  out.write(pad, total - at);
+  out.close();
+  if (!out || rename(tmp.c_str(), name.c_str()) != 0) {
+    cerr << "Error: cannot write image \"" << name << "\"!!" << endl;
+    remove(tmp.c_str());
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,92 @@
+/****************************************************************************
+  FileName     [ cirImage.h ]
+  PackageName  [ cir ]
+  Synopsis     [ Define the memory-mapped circuit image ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#ifndef CIR_IMAGE_H
+#define CIR_IMAGE_H
+
+#include <string>
+
+using namespace std;
+
+// Fixed-size header of a circuit image (native byte order)
+struct CirImageHeader
+{
+  char      magic[8];    // "CIRIMAGE"
+  unsigned  version;
+  unsigned  maxVar, nPI, nLatch, nPO, nAnd;
+  unsigned  nameBytes;   // size of the name blob
+};
+
+// A circuit image is the header followed by fixed-width arrays, each
+// starting at a multiple of 8 bytes:
+//   type[M+1]      uint8, GateType by id, IMG_NO_GATE if there is none
+//   fanin[2(M+1)]  uint32, the fanin literals of the AIG gates by id
+//   line[M+1+O]    uint32, the line numbers of the gates by id, then POs
+//   pi[I]          uint32, the PI ids
+//   po[O]          uint32, the PO literals
+//   order[A]       uint32, the AIG ids in the order they were read
+//   topo[A]        uint32, the AIG ids in topological order
+//   nameOff[I+O+2] uint32, offsets in the blob of the PI names, the PO
+//                  names and the comment; entry k+1 ends entry k
+//   names[]        char
+// The file is mapped read-only and shared. CIRRead -Image copies the
+// arrays into CirGate objects and unmaps the file; the streaming
+// simulation (CirStreamSim) uses them in place for the whole run, so
+// processes that stream the same image share its pages.
+#define IMG_NO_GATE 0xff
+
+class CirImage
+{
+public:
+  enum Section { TYPE, FANIN, LINE, PI, PO, ORDER, TOPO, NAMEOFF, NAMES, SECTIONS };
+
+  CirImage() : _base(0), _size(0) {}
+  ~CirImage() { close(); }
+
+  bool open(const string&);
+  void close();
+  bool isOpen() const { return _base; }
+
+  unsigned maxVar() const { return _h->maxVar; }
+  unsigned numPIs() const { return _h->nPI; }
+  unsigned numLatches() const { return _h->nLatch; }
+  unsigned numPOs() const { return _h->nPO; }
+  unsigned numAnds() const { return _h->nAnd; }
+
+  unsigned char type(unsigned id) const { return _type[id]; }
+  unsigned fanin(unsigned id, int i) const { return _fanin[2*id + i]; }
+  unsigned line(unsigned id) const { return _line[id]; }
+  unsigned poLine(unsigned i) const { return _line[_h->maxVar + 1 + i]; }
+  unsigned pi(unsigned i) const { return _pi[i]; }
+  unsigned po(unsigned i) const { return _po[i]; }
+  unsigned order(unsigned k) const { return _order[k]; }
+  unsigned topo(unsigned k) const { return _topo[k]; }
+  // PI i is name i, PO i is name I+i, and name I+O is the comment
+  string name(unsigned k) const {
+    return string(_names + _nameOff[k], _nameOff[k+1] - _nameOff[k]);
+  }
+
+  // offsets of the sections for h; returns the file size
+  static size_t layout(const CirImageHeader& h, size_t* off);
+
+private:
+  char*                   _base;
+  size_t                  _size;
+  const CirImageHeader*   _h;
+  const unsigned char*    _type;
+  const unsigned*         _fanin;
+  const unsigned*         _line;
+  const unsigned*         _pi;
+  const unsigned*         _po;
+  const unsigned*         _order;
+  const unsigned*         _topo;
+  const unsigned*         _nameOff;
+  const char*             _names;
+};
+
+#endif // CIR_IMAGE_H
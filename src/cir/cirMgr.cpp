@@ -150,7 +150,7 @@ parseError(CirParseError err)
 /*   class CirMgr member functions for circuit construction   */
 /**************************************************************/
 
-inline CirGate* CirMgr::setGate(const unsigned& l, int& id, const GateType& type) {
+CirGate* CirMgr::setGate(const unsigned& l, int& id, const GateType& type) {
   CirGate* mgr;
 
   switch (type) {
@@ -185,6 +185,7 @@ CirMgr::readCircuit(const string& fileName)
    ifstream file;
    file.open(fileName.c_str());
    if (!file.is_open()) { cout << "Cannot open design \"" << fileName << "\"!!" << endl; return false; }
+   _fileName = fileName;
 
    bool storecomment = false;
    int checkin = 0;
@@ -291,7 +292,7 @@ void CirMgr::connect() {
   }
 }
 
-inline void CirMgr::setinput(const unsigned& a, CirGate* gate) {assert(gate != NULL);
+void CirMgr::setinput(const unsigned& a, CirGate* gate) {assert(gate != NULL);
   int id = a / 2;
   size_t phase = a % 2;
   if (!id) {
@@ -373,6 +374,19 @@ void CirMgr::DoDfs() const {
     }
     dfs(o);
     _dfs_done = true;
+    _simValid = false;
+    ++_dfsStamp;
+
+    // levelize for event-driven simulation; _dfsList is topologically sorted
+    _maxLevel = 0;
+    for (size_t i = 0; i < _dfsList.size(); ++i) {
+      unsigned lv = 0;
+      VList in = _dfsList[i]->getInList();
+      for (size_t j = 0; j < in.size(); ++j)
+        if (in[j].gate()->getLevel() + 1 > lv) lv = in[j].gate()->getLevel() + 1;
+      _dfsList[i]->setLevel(lv);
+      if (lv > _maxLevel) _maxLevel = lv;
+    }
 }
 
 void CirMgr::dfs(const VList& srcList) const {
@@ -400,7 +414,7 @@ CirMgr::printPIs() const
 {
    cout << "PIs of the circuit:";
    for (size_t i = 0; i < _PI.size(); ++i) {
-     cout << ' ' << _PI[i]->getId();
+     cout << ' ' << _PI[i]->getOrigId();
    }
    cout << endl;
 }
@@ -410,7 +424,7 @@ CirMgr::printPOs() const
 {
    cout << "POs of the circuit:";
    for (size_t i = 0; i < _PO.size(); ++i) {
-    cout << ' ' << _PO[i]->getId();
+    cout << ' ' << _PO[i]->getOrigId();
    }
    cout << endl;
 }
@@ -419,31 +433,32 @@ void
 CirMgr::printFloatGates() const
 {
   int countf = 0;
-  for (size_t i = 1; i < _list.size(); ++i) {
-    if (_list[i] == NULL) continue;
-    if (_list[i]->getType() == UNDEF_GATE) continue;
-    if (_list[i]->getType() == PI_GATE) continue;
-    if (!countf && _list[i]->faninNO() < 2) {
+  for (size_t i = 1, n = numOrigIds(); i < n; ++i) {
+    CirGate* g = origGate(i);
+    if (g == NULL) continue;
+    if (g->getType() == UNDEF_GATE) continue;
+    if (g->getType() == PI_GATE) continue;
+    if (!countf && g->faninNO() < 2) {
       ++countf;
       cout << "Gates with floating fanin(s):";
     }
-    else if (!countf && _list[i]->getfanin(0).gate()->getType() == UNDEF_GATE) {
+    else if (!countf && g->getfanin(0).gate()->getType() == UNDEF_GATE) {
       ++countf;
       cout << "Gates with floating fanin(s):";
     }
-    else if (!countf && _list[i]->getfanin(1).gate()->getType() == UNDEF_GATE) {
+    else if (!countf && g->getfanin(1).gate()->getType() == UNDEF_GATE) {
       ++countf;
       cout << "Gates with floating fanin(s):";
     }
 
-    if (_list[i]->faninNO() < 2) {
-      cout << " " << _list[i]->getId();
+    if (g->faninNO() < 2) {
+      cout << " " << g->getOrigId();
     }
-    else if (_list[i]->getfanin(0).gate()->getType() == UNDEF_GATE) {
-      cout << " " << _list[i]->getId();
+    else if (g->getfanin(0).gate()->getType() == UNDEF_GATE) {
+      cout << " " << g->getOrigId();
     }
-    else if (_list[i]->getfanin(1).gate()->getType() == UNDEF_GATE) {
-      cout << " " << _list[i]->getId();
+    else if (g->getfanin(1).gate()->getType() == UNDEF_GATE) {
+      cout << " " << g->getOrigId();
     }
   }
   for (size_t i = 0; i < _PO.size(); ++i) {
@@ -452,20 +467,21 @@ CirMgr::printFloatGates() const
         ++countf;
         cout << "Gates with floating fanin(s):";
       }
-      cout << " " << _PO[i]->getId();
+      cout << " " << _PO[i]->getOrigId();
     }
   }
   if (countf) cout << endl;
   int countd = 0;
-  for (size_t i = 1; i < _list.size(); ++i) {
-    if (_list[i] == NULL) continue;
-    if (!countd && _list[i]->getfanout().gate() == NULL) {
+  for (size_t i = 1, n = numOrigIds(); i < n; ++i) {
+    CirGate* g = origGate(i);
+    if (g == NULL) continue;
+    if (!countd && g->getfanout().gate() == NULL) {
       ++countd;
       cout << "Gates defined but not used  :";
     }
 
-    if (_list[i]->getfanout().gate() == NULL) {
-      cout << " " << _list[i]->getId();
+    if (g->getfanout().gate() == NULL) {
+      cout << " " << g->getOrigId();
     }
   }
   if (countd) cout << endl;
@@ -475,7 +491,7 @@ void
 CirMgr::printFECPairs()
 {
   if (!FECs.size()) return;
-  // FECsort();
+  FECsort();
   for (size_t i = 0; i < FECs.size(); ++i) {
     cout << "[" << i << "]";
     bool check = FECs[i][0].first.isInv();
@@ -483,7 +499,7 @@ CirMgr::printFECPairs()
       cout << ' ';
       if (FECs[i][j].first.isInv() && !check) cout << '!';
       else if (!(FECs[i][j].first.isInv()) && check) cout << '!';
-      cout << FECs[i][j].second->getId();
+      cout << FECs[i][j].second->getOrigId();
     }
     cout << endl;
   }
@@ -492,12 +508,12 @@ CirMgr::printFECPairs()
 void
 CirMgr::writeAag(ostream& outfile) const
 {
-  outfile << "aag" << ' ' << _MaxVarnum << ' ' << _PInum << ' ' << _Latchnum << ' ' << _POnum << ' ' << _ANDnum << endl;
+  outfile << "aag" << ' ' << numOrigIds() - 1 << ' ' << _PInum << ' ' << _Latchnum << ' ' << _POnum << ' ' << _ANDnum << endl;
   for (size_t i = 0; i < _PI.size(); ++i) {
-    outfile << 2*(_PI[i]->getId()) << endl;
+    outfile << 2*(_PI[i]->getOrigId()) << endl;
   }
   for (size_t i = 0; i < _PO.size(); ++i) {
-    int id = _PO[i]->getfanin().gate()->getId();
+    int id = _PO[i]->getfanin().gate()->getOrigId();
     id *= 2;
     if (_PO[i]->getfanin().isInv()) ++id;
     outfile << id << endl;
@@ -507,11 +523,11 @@ CirMgr::writeAag(ostream& outfile) const
 
   for (size_t i = 0; i < _dfsList.size(); ++i) {
     if (_dfsList[i]->getType() != AIG_GATE) continue;
-    int in1 = _dfsList[i]->getfanin(0).gate()->getId();
-    int in2 = _dfsList[i]->getfanin(1).gate()->getId();
+    int in1 = _dfsList[i]->getfanin(0).gate()->getOrigId();
+    int in2 = _dfsList[i]->getfanin(1).gate()->getOrigId();
     int in11 = (_dfsList[i]->getfanin(0).isInv() ? 1 : 0);
     int in22 = (_dfsList[i]->getfanin(1).isInv() ? 1 : 0);
-    outfile << 2*(_dfsList[i]->getId()) << ' ' << 2*in1 + in11 << ' ' << 2*in2 + in22 << endl;
+    outfile << 2*(_dfsList[i]->getOrigId()) << ' ' << 2*in1 + in11 << ' ' << 2*in2 + in22 << endl;
   }
 
   for (size_t i = 0; i < _PI.size(); ++i) {
@@ -565,20 +581,20 @@ CirMgr::writeGate(ostream& outfile, CirGate *g) const
   CirGate::setGlobalRef();
   dfswrite(po, pi, new_dfs_aig, new_dfs_pi);
 
-  outfile << "aag " << g->getId() << ' ' << pi << " 0 1 " << new_dfs_aig.size() << endl;
+  outfile << "aag " << g->getOrigId() << ' ' << pi << " 0 1 " << new_dfs_aig.size() << endl;
   for (size_t i = 0; i < new_dfs_pi.size(); ++i) {
     if (new_dfs_pi[i] == 0)
-      outfile << 2*(_PI[i]->getId()) << endl;
+      outfile << 2*(_PI[i]->getOrigId()) << endl;
   }
-  outfile << 2*(g->getId()) << endl;
+  outfile << 2*(g->getOrigId()) << endl;
   for (size_t i = 0; i < new_dfs_aig.size(); ++i) {
     unsigned id0 = (new_dfs_aig[i]->getfanin(0).isInv() ? 1 : 0);
     unsigned id1 = (new_dfs_aig[i]->getfanin(1).isInv() ? 1 : 0);
-    id0 += 2*(new_dfs_aig[i]->getfanin(0).gate()->getId());
-    id1 += 2*(new_dfs_aig[i]->getfanin(1).gate()->getId());
-    outfile << 2*(new_dfs_aig[i]->getId()) << ' ' << id0 << ' ' << id1 << endl;
+    id0 += 2*(new_dfs_aig[i]->getfanin(0).gate()->getOrigId());
+    id1 += 2*(new_dfs_aig[i]->getfanin(1).gate()->getOrigId());
+    outfile << 2*(new_dfs_aig[i]->getOrigId()) << ' ' << id0 << ' ' << id1 << endl;
   }
-  outfile << "o0 " << g->getId() << endl << 'c' << endl << "Write gate (" << g->getId() << ')' << endl;
+  outfile << "o0 " << g->getOrigId() << endl << 'c' << endl << "Write gate (" << g->getOrigId() << ')' << endl;
 }
 
 CirGate* CirMgr::getGate(unsigned gid) const {
@@ -586,9 +602,9 @@ CirGate* CirMgr::getGate(unsigned gid) const {
     _renewfec = false;
     renewFec();
   }
-  if (gid <= unsigned(_MaxVarnum)) return _list[gid];
+  if (gid < numOrigIds()) return origGate(gid);
   for (size_t i = 0; i < _PO.size(); i++) {
-    if (gid == _PO[i]->getId()) return _PO[i];
+    if (gid == _PO[i]->getOrigId()) return _PO[i];
   }
   return 0;
 }
@@ -13,6 +13,7 @@
 #include <string>
 #include <fstream>
 #include <iostream>
+#include <atomic>
 
 using namespace std;
 
@@ -20,8 +21,16 @@ using namespace std;
 
 // #include "cirDef.h"
 #include "cirGate.h"
+#include "cirFec.h"
+#include "cirSolver.h"
+#include "cirTruth.h"
 
 extern CirMgr *cirMgr;
+extern bool convertPatFile(const string&, const string&);
+extern void writeBinHeader(ostream&, unsigned nPI, unsigned nPO, Simtype nPat);
+extern void patchBinHeader(ostream&, Simtype nPat);
+
+struct FraigTask;
 
 class AigVs
 {
@@ -37,10 +46,37 @@ private:
 };
 
 
+// one telemetry sample of CIRSIMulate -Random
+struct SimRound
+{
+  unsigned  round;     // #simulation rounds (64 patterns each) so far
+  size_t    patterns;
+  size_t    groups;    // #FEC groups
+  size_t    largest;   // size of the largest FEC group
+  double    seconds;   // wall time since the start of the command
+};
+
+// the union of the fanin cones of an FEC group, compiled into a flat
+// topologically sorted program; slots [0, leaves) are loaded from the
+// PIs/CONST, slot leaves + k is the output of op k, and op k reads the
+// literals ops[2k] and ops[2k+1] (slot << 1 | inverted)
+struct ConeProg
+{
+  ConeProg() : members(0), stamp(0) {}
+  size_t            members;  // size of the group it was compiled for
+  unsigned          stamp;    // _dfsStamp when compiled
+  GateList          leaves;
+  GateList          ands;
+  vector<unsigned>  ops;
+};
+
 class CirMgr
 {
 public:
-   CirMgr() : _dfs_done(false), solver(NULL), _renewfec(false) {}
+   CirMgr() : _simLog(0), _simLogBin(false), _dfs_done(false), _renewfec(false), _maxLevel(0), _simValid(false), _distNext(0), _recordPat(true),
+              _simBudgetPat(0), _simBudgetTime(0), _simBudgetStall(0), _splits(0),
+              _dfsStamp(0), _coneOps(0), _ckptEvery(0), _ckptCalls(0), _diffSorted(0), _threads(1), _spec(false), _sched(false),
+              _confBudget(-1), _retryBudget(-1) {}
    ~CirMgr() {
      for (size_t i = 0; i < _PO.size(); ++i) {
        if (_PO[i] != NULL) {
@@ -58,23 +94,54 @@ public:
    // Access functions
    // return '0' if "gid" corresponds to an undefined gate.
    CirGate* getGate(unsigned gid) const;
+   // the FEC group of g, in canonical order
+   FecGrp getFecGrp(const CirGate* g) {
+     FECsort();
+     return (g->getFecId() < 0 ? FecGrp() : FECs.group(g->getFecId()));
+   }
 
    // Member functions about circuit construction
    bool readCircuit(const string&);
+   // a circuit image is mapped and its arrays are used without parsing
+   bool readImage(const string&);
+   bool writeImage(const string&) const;
 
    // Member functions about circuit optimization
    void sweep();
    void optimize();
+   // renumbers the gates in DFS order; see getOrigId()
+   void reorder();
 
    // Member functions about simulation
    void randomSim();
    void fileSim(ifstream&);
-   void setSimLog(ofstream *logFile) { _simLog = logFile; }
+   void setSimLog(ofstream *logFile, bool binary = false);
+   // 0 means no budget
+   void setSimBudget(size_t patterns, double seconds, unsigned stall);
 
    // Member functions about fraig
    void strash();
    void printFEC() const;
    void fraig();
+   // fraig() proves the FEC groups on n threads
+   void setThreads(unsigned n) { _threads = n; }
+   // fraig() proves all FEC groups at once on a speculatively reduced model
+   void setSpeculate(bool s) { _spec = s; }
+   // fraig() proves the pairs cheapest first; the order goes to the trace
+   // file unless it is ""
+   void setSchedule(bool s, const string& trace) { _sched = s; _traceFile = trace; }
+   // conflicts per SAT call of fraig(), and per call of the retry of the
+   // pairs left undecided at the end; -1 for no limit and no retry
+   void setConfBudget(int conf, int retry) { _confBudget = conf; _retryBudget = retry; }
+
+   // Member functions about session checkpoints
+   bool saveSession(const string&);
+   bool loadSession(const string&);
+   // fraig() rewrites the checkpoint every "every" SAT calls; "" for none
+   void setCheckpoint(const string& file, unsigned every) {
+     _ckptFile = file; _ckptEvery = every;
+   }
+   size_t numFecGroups() const { return FECs.size(); }
 
    // Member functions about circuit reporting
    void printSummary() const;
@@ -83,6 +150,7 @@ public:
    void printPOs() const;
    void printFloatGates() const;
    void printFECPairs();
+   void printSimStats() const;
    void writeAag(ostream&) const;
    void writeGate(ostream&, CirGate*) const;
 
@@ -90,7 +158,8 @@ public:
    void testPI();
 private:  
    ofstream           *_simLog;
-   SatSolver          *solver;
+   bool                _simLogBin;   // _simLog is a packed binary log
+   Simtype             _logPatterns; // #patterns in the binary log so far
 
    int                 _PInum;
    int                 _POnum;
@@ -108,23 +177,83 @@ private:
    
    mutable bool        _dfs_done;
    mutable bool        _renewfec;
+   mutable unsigned    _maxLevel;
+   mutable bool        _simValid;   // every gate in _dfsList holds the value of the current PIs
    
    vector<Simtype>     _simPat;
    vector<Simtype>     _simResult;
+   vector<Simtype>     _patRows;    // row-major pattern blocks for fileSim
+   vector<vector<Simtype> > _distPat; // PI patterns that split FEC groups (bit i = PI i)
+   size_t              _distNext;
+   vector<vector<Simtype> > _patStore; // PI words of the rounds that split a group
+   bool                _recordPat;
+   string              _fileName;
+   vector<unsigned>    _newId;       // id by original id after reorder(); 0 if gone
+
+   // budgets and telemetry of randomSim
+   size_t              _simBudgetPat;
+   double              _simBudgetTime;
+   unsigned            _simBudgetStall;
+   size_t              _splits;      // #FEC group splits so far
+   size_t              _lastSplits;
+   unsigned            _stallRounds; // #rounds without a split
+   double              _simStart;
+   double              _lastSample;
+   string              _simStop;     // the budget that stopped randomSim
+   vector<SimRound>    _simStats;
+
+   // compiled cones of simFEC, by the id of the first member of the group
+   mutable unsigned    _dfsStamp;    // bumped by every DoDfs
+   vector<ConeProg>    _coneProg;
+   size_t              _coneOps;     // #ops cached in _coneProg
+   vector<Simtype>     _coneVal;
+   vector<unsigned>    _coneSlot;
+   vector<Simtype>     _fecDiff;     // scratch of updateFec()
+   vector<char>        _exhPhase;    // gate phases of exhaustGroup(), by id
+   vector<char>        _justVal;    // 0: unassigned, 1: 0, 2: 1 (by gate id)
+   vector<GateList>    _eventQ;     // levelized queue for event-driven simulation
    vector<string>      comment;
 
    
-   vector<FEC>         FECs;
-   vector<int>         FECnotChange;
+   FecStore            FECs;
+
+   // session checkpoints
+   string              _ckptFile;
+   unsigned            _ckptEvery;
+   unsigned            _ckptCalls;   // #SAT calls since the last checkpoint
+   vector<Simtype>     _diffPairs;   // gate pairs proven different, a << 32 | b (a < b)
+   size_t              _diffSorted;  // _diffPairs[0, _diffSorted) is sorted
+
+   FraigSolver         _fraigSat;
+   TruthChecker        _truth;
+   WindowSolver        _window;
+   size_t              _byTruth;     // #pairs of fraig() decided by _truth
+   size_t              _byWindow;    // #pairs of fraig() proven by _window
+   unsigned            _threads;
+   bool                _spec;
+   bool                _sched;
+   string              _traceFile;
+   int                 _confBudget;
+   int                 _retryBudget;
+   vector<MergeNode>   _undecided;  // pairs out of budget, with the phases in
+   vector<bool>        _undecPhase; // the way of ToBeMerge and mergePhase
+   vector<Simtype>     _cexWord;    // counterexamples by PI, one per bit
+   unsigned            _cexCount;   // #bits of _cexWord taken
 
    vector<int>         Err;
    vector<MergeNode>   ToBeMerge;
    vector<bool>        mergePhase;
 
-   inline CirGate* setGate(const unsigned&, int&, const GateType&);
-   inline void setinput(const unsigned&, CirGate*);
+   CirGate* setGate(const unsigned&, int&, const GateType&);
+   void setinput(const unsigned&, CirGate*);
    void connect();
    void DoDfs() const;
+   // the ids in the circuit file are [0, numOrigIds())
+   size_t numOrigIds() const { return (_newId.empty() ? _list.size() : _newId.size()); }
+   CirGate* origGate(size_t i) const {
+     if (_newId.empty()) return _list[i];
+     return ((i && !_newId[i]) ? 0 : _list[_newId[i]]);
+   }
    void dfs(const VList&) const;
    
    
@@ -143,33 +272,66 @@ private:
    // private method for optimization
 
    // pravate method for simulation
-   inline void setSimPattern(const string& buf);
+   inline void binFileSim(ifstream&, unsigned, unsigned, Simtype);
+   inline bool packPattern(const char*, size_t);
+   inline void flushPattern();
    inline void Initsim();
    inline bool InitFec();
-   inline void updateFec();
-   inline void updateFec(int);
-   inline void FECsort();
+   inline bool updateFec();
+   inline bool updateFec(int);
+   void FECsort();
    inline void genPattern();
    inline void setPat();
    inline void simFEC(size_t&);
    inline void specialFECsim(const size_t&);
+   void coneSim(const size_t&);
+   void evalCone(const ConeProg&);
+   bool exactSim(unsigned&);
+   bool exhaustGroup(unsigned, unsigned&, size_t&);
+   void compileCone(const FecGrp&, ConeProg&);
+   bool simRound(const unsigned&, bool force = false);
+   void guidedSim(unsigned&);
+   bool genGuidedPattern(const size_t&, const vector<int>&);
+   void justify(CirGate*, bool, vector<unsigned>&);
+   inline void recordDist(const Simtype&);
+   void recordWord();
+   void compactPatStore();
+   void savePatStore();
+   void loadPatStore(unsigned&);
    void LinkFecToGate();
    void SimWrite();
    void sim();
+   void eventSim(const GateList&);
+   inline void scheduleFanout(CirGate*);
    bool checkSim(const string&);
    void printFECnum() const;
 
+   // private method for session checkpoints
+   bool writeSession(const string&, const vector<GateList>*, const vector<vector<bool> >*);
+   void addDiff(unsigned, unsigned);
+   bool provenDiff(unsigned, unsigned) const;
+
    // private method for fraig
-   void genProofModel(SatSolver*& s);
+   void fraigThreads();
+   void fraigSpec();
+   void fraigSchedule();
+   void dfsPos(vector<unsigned>&) const;
+   void proveTasks(vector<FraigTask>&, const vector<unsigned>&, atomic<size_t>&, const vector<unsigned>&);
+   void resimTasks(const vector<char>&);
+   void fraigDone(size_t);
+   void retryUndecided();
    void reportResult(const SatSolver& solver, bool result);
    bool simEachFec(size_t);
 
    //private method for fraig
-   inline bool prove(CirGate*, bool, CirGate*, bool, SatSolver*&);
-   inline bool record(const bool&, SatSolver*&, vector<vector<char*> >&, const size_t&);
+   inline int prove(CirGate*, CirGate*, bool);
+   inline void newCexWord();
+   inline void record(bool byTruth = false);
+   inline int decide(FraigSolver&, TruthChecker&, WindowSolver&, CirGate*, CirGate*, bool,
+                     ProveStage&);
+   void resimCex(vector<GateList>&, vector<vector<bool> >&);
    inline void renewFec() const;
-   inline void initVar();
-   inline void updateBySim(vector<GateList>& hash, vector<vector<bool> >&, vector<vector<char*> >&, const int&);
+   inline void recycleSolver();
 };
 
 #endif // CIR_MGR_H
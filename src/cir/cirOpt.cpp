@@ -7,6 +7,7 @@
 ****************************************************************************/
 
 #include <cassert>
+#include <algorithm>
 #include "cirMgr.h"
 #include "cirGate.h"
 #include "util.h"
@@ -41,7 +42,7 @@ CirMgr::sweep()
     if (_list[i]->getType() == PO_GATE) continue;
     if (_list[i]->InDfs()) continue;
 
-    cout << "Sweeping: " << _list[i]->getTypeStr() << "(" << _list[i]->getId() << ") removed..." << endl;
+    cout << "Sweeping: " << _list[i]->getTypeStr() << "(" << _list[i]->getOrigId() << ") removed..." << endl;
     if (_list[i]->getType() == AIG_GATE) --_ANDnum;
     // delete _list[i];
     _list[i] = NULL;
@@ -77,14 +78,14 @@ void CirMgr::ModifyOut() {
 // _dfsList needs to be reconstructed afterwards
 // UNDEF gates may be delete if its fanout becomes empty...
 inline void print_merging_message(CirGate* g, CirGate*& h, bool inv) {
-  cout << "Simplifying: " << g->getId() << " merging ";
+  cout << "Simplifying: " << g->getOrigId() << " merging ";
   if (inv) cout << '!'; 
-  cout << h->getId() << "..." << endl;// << endl;
+  cout << h->getOrigId() << "..." << endl;// << endl;
 }
 
 inline void print_merging_message_0(CirGate*& h) {
   cout << "Simplifying: 0 merging ";
-  cout << h->getId() << "..." << endl;// << endl;
+  cout << h->getOrigId() << "..." << endl;// << endl;
 }
 
 void
@@ -133,6 +134,86 @@ CirMgr::optimize() // core dumped after calling destructor in cirMgr
   }
 }
 
+// Renumbers the gates: CONST 0, the PIs, the AIG gates in DFS order, then
+// the AIG gates no PO reaches and the UNDEF gates. The gates are rebuilt
+// in that order, so a gate is allocated right after its fanins and the
+// vectors indexed by id are walked forward by the topological passes.
+// The gates keep their ids in the circuit file (getOrigId()) for printing
+// and writing, and getGate() looks them up by those ids.
+void
+CirMgr::reorder()
+{
+  assert(!FECs.size());
+  if (!_dfs_done) DoDfs();
+  const size_t n = _list.size();
+  vector<unsigned> nid(n, 0);   // new id by current id
+  GateList order(1, _list[0]);  // the current gates by new id
+  for (size_t i = 0; i < _PI.size(); ++i) {
+    nid[_PI[i]->getId()] = order.size(); order.push_back(_PI[i]);
+  }
+  for (size_t i = 0; i < _dfsList.size(); ++i) {
+    if (_dfsList[i]->getType() != AIG_GATE) continue;
+    nid[_dfsList[i]->getId()] = order.size(); order.push_back(_dfsList[i]);
+  }
+  for (int pass = 0; pass < 2; ++pass) {
+    const GateType t = (pass ? UNDEF_GATE : AIG_GATE);
+    for (size_t i = 1; i < n; ++i) {
+      if (!_list[i] || nid[i] || _list[i]->getType() != t) continue;
+      nid[i] = order.size(); order.push_back(_list[i]);
+    }
+  }
+
+  GateList oldPO = _PO;
+  for (size_t i = 0; i < _dfsList.size(); ++i) _dfsList[i]->resetDfs();
+  _dfsList.clear();
+  _list.assign(order.size(), 0); _PI.clear(); _PO.clear();
+  _MaxVarnum = order.size() - 1;
+  _list[0] = new CONSTGate(0, order[0]->getLineNo());
+  for (size_t k = 1; k < order.size(); ++k) {
+    CirGate* g = order[k];
+    int l = 2 * k;
+    if (g->getType() == PI_GATE) setGate(g->getLineNo(), l, PI_GATE)->setname(g->getName());
+    else if (g->getType() == AIG_GATE) setGate(g->getLineNo(), l, AIG_GATE);
+    else _list[k] = new UNDEFGate(k);
+  }
+  // fanins are connected in the order of the file, as readCircuit() does,
+  // so that the fanout lists come out the same
+  vector<pair<unsigned, unsigned> > byLine;  // (line, new id)
+  for (size_t k = 1; k < order.size(); ++k)
+    if (order[k]->getType() == AIG_GATE) byLine.push_back(make_pair(order[k]->getLineNo(), k));
+  sort(byLine.begin(), byLine.end());
+  for (size_t i = 0; i < byLine.size(); ++i) {
+    const unsigned k = byLine[i].second;
+    for (int j = 0; j < 2; ++j) {
+      const CirGateV in = order[k]->getfanin(j);
+      setinput(2 * nid[in.gate()->getId()] + in.isInv(), _list[k]);
+    }
+  }
+  for (size_t i = 0; i < oldPO.size(); ++i) {
+    const CirGateV in = oldPO[i]->getfanin();
+    int l = 2 * nid[in.gate()->getId()] + in.isInv();
+    setGate(oldPO[i]->getLineNo(), l, PO_GATE)->setname(oldPO[i]->getName());
+  }
+  connect();
+
+  // compose the mapping from the ids in the file
+  if (_newId.empty())
+    for (size_t i = 0; i < n; ++i) _newId.push_back(i);
+  for (size_t i = 1; i < _newId.size(); ++i)
+    if (_newId[i]) _newId[i] = nid[_newId[i]];
+  for (size_t k = 0; k < order.size(); ++k) {
+    _list[k]->setOrigId(order[k]->getOrigId());
+    delete order[k];
+  }
+  for (size_t i = 0; i < oldPO.size(); ++i) {
+    _PO[i]->setOrigId(oldPO[i]->getOrigId());
+    delete oldPO[i];
+  }
+  _coneProg.clear(); _coneOps = 0;
+  _diffPairs.clear(); _diffSorted = 0;
+  DoDfs();
+}
+
 /***************************************************/
 /*   Private member functions about optimization   */
 /***************************************************/
@@ -0,0 +1,310 @@
+/****************************************************************************
+  FileName     [ cirSession.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define session checkpoints of simulation and fraig ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include "cirMgr.h"
+#include "cirGate.h"
+
+using namespace std;
+
+/*******************************/
+/*   Global variable and enum  */
+/*******************************/
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+// Session file (native byte order):
+//   "FRAIGSES" | uint32 version |
+//   uint32 M I L O A | PI: id, line | PO: literal, line |
+//   AIG: id, literal0, literal1, line | PI and PO names | comment lines |
+//   design file name |
+//   uint8 simValid | #ids, per id: the simulation word of its gate (0 if none) |
+//   #groups, per group: uint8 exact, uint32 n, n literals |
+//   #pending merges, per merge: uint32 id0, id1, uint8 inverted |
+//   #pairs proven different, per pair: uint64 id0 << 32 | id1 |
+//   #distinguishing pattern words, per word: I words
+// A string is a uint32 length and its characters. A literal of a group
+// member is 2 * id + phase of its SimKey; the key is the word of the gate
+// in that phase, so the groups and the values resume as they were saved.
+static const char sesMagic[8] = { 'F', 'R', 'A', 'I', 'G', 'S', 'E', 'S' };
+#define SES_VERSION 2
+
+template<class T> static inline void put(ostream& os, const T& v) {
+  os.write((const char*)&v, sizeof(T));
+}
+
+template<class T> static inline bool get(istream& is, T& v) {
+  is.read((char*)&v, sizeof(T));
+  return bool(is);
+}
+
+static void putStr(ostream& os, const string& s) {
+  put(os, unsigned(s.size()));
+  os.write(s.data(), s.size());
+}
+
+static bool getStr(istream& is, string& s) {
+  unsigned n;
+  if (!get(is, n) || n > (1u << 24)) return false;
+  s.resize(n);
+  if (n) is.read(&s[0], n);
+  return bool(is);
+}
+
+static bool sesError(const string& name) {
+  cerr << "Error: session file \"" << name << "\" is corrupted!!" << endl;
+  return false;
+}
+
+/****************************************************/
+/*   class CirMgr member functions about sessions   */
+/****************************************************/
+bool CirMgr::saveSession(const string& name) {
+  if (!writeSession(name, 0, 0)) return false;
+  cout << "Session saved to \"" << name << "\"." << endl;
+  return true;
+}
+
+// Rebuilds the circuit without parsing any text and restores the merges
+// that were proven but not done yet, the simulation words of the gates,
+// the FEC groups, the pairs proven different and the distinguishing
+// patterns. A following CIRFraig skips
+// every pair that has been proven already.
+bool CirMgr::loadSession(const string& name) {
+  ifstream in(name.c_str(), ios::in | ios::binary);
+  if (!in) { cout << "Cannot open session \"" << name << "\"!!" << endl; return false; }
+  char magic[8];
+  unsigned ver;
+  in.read(magic, 8);
+  if (in.gcount() != 8 || memcmp(magic, sesMagic, 8) != 0 ||
+      !get(in, ver) || ver != SES_VERSION) {
+    cerr << "Error: \"" << name << "\" is not a session file!!" << endl;
+    return false;
+  }
+
+  // circuit
+  unsigned M, I, L, O, A;
+  if (!get(in, M) || !get(in, I) || !get(in, L) || !get(in, O) || !get(in, A))
+    return sesError(name);
+  _MaxVarnum = M; _PInum = I; _Latchnum = L; _POnum = O; _ANDnum = A;
+  _list.resize(M + 1);
+  _list[0] = new CONSTGate(0, 0);
+  unsigned id, line, lit, lit0, lit1;
+  for (unsigned i = 0; i < I; ++i) {
+    if (!get(in, id) || !get(in, line)) return sesError(name);
+    if (!id || id > M || _list[id]) return sesError(name);
+    int l = 2 * id;
+    setGate(line, l, PI_GATE);
+  }
+  for (unsigned i = 0; i < O; ++i) {
+    if (!get(in, lit) || !get(in, line) || lit / 2 > M) return sesError(name);
+    int l = lit;
+    setGate(line, l, PO_GATE);
+  }
+  vector<unsigned> ands(3 * A);
+  for (unsigned i = 0; i < A; ++i) {
+    if (!get(in, id) || !get(in, lit0) || !get(in, lit1) || !get(in, line))
+      return sesError(name);
+    if (!id || id > M || _list[id] || lit0 / 2 > M || lit1 / 2 > M)
+      return sesError(name);
+    int l = 2 * id;
+    setGate(line, l, AIG_GATE);
+    ands[3*i] = id; ands[3*i+1] = lit0; ands[3*i+2] = lit1;
+  }
+  for (unsigned i = 0; i < A; ++i) {
+    setinput(ands[3*i+1], _list[ands[3*i]]);
+    setinput(ands[3*i+2], _list[ands[3*i]]);
+  }
+  string s;
+  for (unsigned i = 0; i < I + O; ++i) {
+    if (!getStr(in, s)) return sesError(name);
+    if (s.size()) (i < I ? _PI[i] : _PO[i - I])->setname(s);
+  }
+  unsigned n;
+  if (!get(in, n)) return sesError(name);
+  comment.resize(n);
+  for (unsigned i = 0; i < n; ++i)
+    if (!getStr(in, comment[i])) return sesError(name);
+  if (!getStr(in, _fileName)) return sesError(name);
+  connect();
+  DoDfs();
+
+  // merges proven before the checkpoint; like in fraig(), they are done
+  // at its end, so that their gates stay in the DFS list until then
+  if (!get(in, n)) return sesError(name);
+  for (unsigned i = 0; i < n; ++i) {
+    unsigned char inv;
+    if (!get(in, lit0) || !get(in, lit1) || !get(in, inv)) return sesError(name);
+    if (lit0 > M || lit1 > M || !_list[lit0] || !_list[lit1]) return sesError(name);
+    ToBeMerge.push_back(MergeNode(_list[lit0], _list[lit1]));
+    mergePhase.push_back(inv);
+  }
+
+  // simulation words
+  unsigned char valid;
+  if (!get(in, valid) || !get(in, n)) return sesError(name);
+  for (unsigned i = 0; i < n; ++i) {
+    Simtype v;
+    if (!get(in, v)) return sesError(name);
+    if (i < _list.size() && _list[i]) _list[i]->setValue(v);
+  }
+  _simValid = valid;
+
+  // FEC groups
+  if (!get(in, n)) return sesError(name);
+  FECs.clear();
+  SimKey k(0);
+  FEC members;
+  for (unsigned i = 0; i < n; ++i) {
+    unsigned char exact;
+    unsigned cnt;
+    if (!get(in, exact) || !get(in, cnt)) return sesError(name);
+    members.clear();
+    for (unsigned j = 0; j < cnt; ++j) {
+      if (!get(in, lit) || lit / 2 > M || !_list[lit / 2]) return sesError(name);
+      const Simtype v = _list[lit / 2]->value();
+      members.push_back(SimNode(k, _list[lit / 2]));
+      members.back().first.set((lit & 1) ? ~v : v, lit & 1);
+    }
+    FECs.add(members, exact);
+  }
+  LinkFecToGate();
+  if (!FECs.size() && ToBeMerge.size()) { merge(); DoDfs(); }
+
+  // pairs proven different and distinguishing patterns
+  if (!get(in, n)) return sesError(name);
+  _diffPairs.resize(n);
+  for (unsigned i = 0; i < n; ++i)
+    if (!get(in, _diffPairs[i])) return sesError(name);
+  sort(_diffPairs.begin(), _diffPairs.end());
+  _diffSorted = n;
+  if (!get(in, n)) return sesError(name);
+  _patStore.assign(n, vector<Simtype>(I));
+  for (unsigned i = 0; i < n; ++i)
+    if (I && !in.read((char*)_patStore[i].data(), I * sizeof(Simtype)))
+      return sesError(name);
+
+  cout << "Session loaded from \"" << name << "\": #FEC Group = " << FECs.size()
+       << ", " << _diffSorted << " pairs proven different." << endl;
+  return true;
+}
+
+/*****************************************************/
+/*   Private member functions about session files    */
+/*****************************************************/
+// The group of id is hash[id] (the members fraig() has kept so far, with
+// their phases in inv[id]) and the members left in FECs. The file is
+// written next to name and renamed over it, so a process killed while
+// writing leaves the previous checkpoint intact.
+bool CirMgr::writeSession(const string& name, const vector<GateList>* hash,
+                          const vector<vector<bool> >* inv) {
+  const string tmp = name + ".tmp";
+  ofstream out(tmp.c_str(), ios::out | ios::binary);
+  if (!out) { cerr << "Cannot open \"" << tmp << "\"!!" << endl; return false; }
+  out.write(sesMagic, 8);
+  put(out, unsigned(SES_VERSION));
+
+  // circuit
+  unsigned nAnd = 0;
+  for (size_t i = 1; i < _list.size(); ++i)
+    if (_list[i] && _list[i]->getType() == AIG_GATE) ++nAnd;
+  put(out, unsigned(_MaxVarnum)); put(out, unsigned(_PI.size()));
+  put(out, unsigned(_Latchnum)); put(out, unsigned(_PO.size())); put(out, nAnd);
+  for (size_t i = 0; i < _PI.size(); ++i) {
+    put(out, _PI[i]->getId()); put(out, _PI[i]->getLineNo());
+  }
+  for (size_t i = 0; i < _PO.size(); ++i) {
+    const CirGateV in = _PO[i]->getfanin();
+    put(out, unsigned(2 * in.gate()->getId() + in.isInv()));
+    put(out, _PO[i]->getLineNo());
+  }
+  for (size_t i = 1; i < _list.size(); ++i) {
+    if (!_list[i] || _list[i]->getType() != AIG_GATE) continue;
+    const CirGateV in0 = _list[i]->getfanin(0), in1 = _list[i]->getfanin(1);
+    put(out, _list[i]->getId());
+    put(out, unsigned(2 * in0.gate()->getId() + in0.isInv()));
+    put(out, unsigned(2 * in1.gate()->getId() + in1.isInv()));
+    put(out, _list[i]->getLineNo());
+  }
+  for (size_t i = 0; i < _PI.size(); ++i) putStr(out, _PI[i]->getName());
+  for (size_t i = 0; i < _PO.size(); ++i) putStr(out, _PO[i]->getName());
+  put(out, unsigned(comment.size()));
+  for (size_t i = 0; i < comment.size(); ++i) putStr(out, comment[i]);
+  putStr(out, _fileName);
+
+  // merges proven but not done yet
+  put(out, unsigned(ToBeMerge.size()));
+  for (size_t i = 0; i < ToBeMerge.size(); ++i) {
+    put(out, ToBeMerge[i].first->getId()); put(out, ToBeMerge[i].second->getId());
+    put(out, (unsigned char)mergePhase[i]);
+  }
+
+  // simulation words
+  put(out, (unsigned char)_simValid);
+  put(out, unsigned(_list.size()));
+  for (size_t i = 0; i < _list.size(); ++i)
+    put(out, (_list[i] ? _list[i]->value() : Simtype(0)));
+
+  // FEC groups; the count is known only at the end
+  vector<unsigned> grp;
+  unsigned nGrp = 0;
+  for (unsigned id = 0; id < FECs.numIds(); ++id) {
+    const size_t head = grp.size();
+    grp.push_back(FECs.exact(id)); grp.push_back(0);
+    if (hash && id < hash->size())
+      for (size_t j = 0; j < (*hash)[id].size(); ++j)
+        grp.push_back(2 * (*hash)[id][j]->getId() + (*inv)[id][j]);
+    FecGrp g = FECs.group(id);
+    for (size_t j = 0; j < g.size(); ++j)
+      grp.push_back(2 * g[j].second->getId() + g[j].first.isInv());
+    grp[head + 1] = grp.size() - head - 2;
+    if (grp[head + 1] < 2) { grp.resize(head); continue; }
+    ++nGrp;
+  }
+  put(out, nGrp);
+  for (size_t j = 0; j < grp.size(); j += grp[j + 1] + 2) {
+    put(out, (unsigned char)grp[j]); put(out, grp[j + 1]);
+    out.write((const char*)&grp[j + 2], grp[j + 1] * sizeof(unsigned));
+  }
+
+  // pairs proven different and distinguishing patterns
+  put(out, unsigned(_diffPairs.size()));
+  if (_diffPairs.size())
+    out.write((const char*)_diffPairs.data(), _diffPairs.size() * sizeof(Simtype));
+  put(out, unsigned(_patStore.size()));
+  for (size_t w = 0; w < _patStore.size(); ++w)
+    out.write((const char*)_patStore[w].data(), _PI.size() * sizeof(Simtype));
+
+  out.close();
+  if (!out || rename(tmp.c_str(), name.c_str()) != 0) {
+    cerr << "Error: cannot write session \"" << name << "\"!!" << endl;
+    remove(tmp.c_str());
+    return false;
+  }
+  return true;
+}
+
+void CirMgr::addDiff(unsigned a, unsigned b) {
+  if (a > b) swap(a, b);
+  _diffPairs.push_back((Simtype(a) << 32) | b);
+}
+
+// only the pairs of a loaded session are looked up; fraig() never asks
+// for a pair twice in one run
+bool CirMgr::provenDiff(unsigned a, unsigned b) const {
+  if (!_diffSorted) return false;
+  if (a > b) swap(a, b);
+  return binary_search(_diffPairs.begin(), _diffPairs.begin() + _diffSorted,
+                       (Simtype(a) << 32) | b);
+}
@@ -13,12 +13,27 @@
 #include <cassert>
 #include <sstream>
 #include <cmath>
+#include <cstring>
+#include <sys/time.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include "cirMgr.h"
 #include "cirGate.h"
 #include "util.h"
 
 #define MAX_BIT 64
 #define Simtype_MAX 0xffffffffffffffff
+#define SIM_BUF_SIZE (1 << 20)
+#define DIST_PAT_MAX 256  // #distinguishing patterns kept for guided simulation
+#define GUIDE_TRY    3    // #guided rounds spent on one FEC group
+#define GUIDE_ROUND  512  // #guided rounds per randomSim
+#define STAT_GAP     0.01 // min. seconds between two telemetry samples
+#define STAT_RATIO   0.25 // ... or this fraction of the elapsed time
+#define CONE_OPS_MAX (1<<22) // max. #ops kept in the compiled cone cache
+#define EXH_PI_MAX   20   // max. #PIs in a cone for exhaustive simulation
+#define EXH_WORK_MAX (size_t(1)<<26) // max. word ops to spend on one group
+#define EXH_TOTAL_MAX (size_t(1)<<30) // ... and on all groups of one pass
 
 using namespace std;
 
@@ -40,6 +55,67 @@ static char errChar;
 static int correct_num;
 static int limit;
 static int leave;
+static string logBuf;
+
+// In-place transpose of a 64x64 bit matrix:
+// bit c of a[r] <=> bit r of a[c] (bit 0 is the LSB).
+// Swaps the off-diagonal blocks of size 32, 16, ..., 1 in turn.
+static void transpose64(Simtype* a) {
+  Simtype m = 0x00000000ffffffffULL;
+  for (int j = 32; j != 0; j >>= 1, m ^= (m << j)) {
+    for (int k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+      Simtype t = ((a[k] >> j) ^ a[k | j]) & m;
+      a[k] ^= (t << j);
+      a[k | j] ^= t;
+    }
+  }
+}
+
+// Packs up to 64 '0'/'1' characters into one word, character i -> bit i.
+// Returns false if there is any other character.
+static bool packRow(const char* s, size_t n, Simtype& row) {
+  row = 0;
+  size_t i = 0;
+#ifdef __SSE2__
+  const __m128i one = _mm_set1_epi8(1), zero = _mm_set1_epi8('0');
+  for (; i + 16 <= n; i += 16) {
+    __m128i c = _mm_loadu_si128((const __m128i*)(s + i));
+    __m128i d = _mm_sub_epi8(c, zero);
+    // any byte other than 0/1 after subtracting '0' is illegal
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_andnot_si128(one, d), _mm_setzero_si128())) != 0xffff)
+      return false;
+    Simtype bits = unsigned(_mm_movemask_epi8(_mm_slli_epi64(d, 7)));
+    row |= bits << i;
+  }
+#endif
+  for (; i < n; ++i) {
+    if (s[i] != '0' && s[i] != '1') return false;
+    row |= Simtype(s[i] - '0') << i;
+  }
+  return true;
+}
+
+// Unpacks the low n bits of row into '0'/'1' characters, bit i -> s[i].
+static void unpackRow(Simtype row, size_t n, char* s) {
+  for (size_t i = 0; i < n; ++i, row >>= 1)
+    s[i] = char('0' + (row & Simtype(KEY)));
+}
+
+// Bit p of words[i] becomes character (offset + i) of line p,
+// where each line is "width" characters long.
+static void unpackWords(const vector<Simtype>& words, int patterns, char* out,
+                        size_t offset, size_t width) {
+  Simtype rows[MAX_BIT];
+  for (size_t i = 0; i < words.size(); i += MAX_BIT) {
+    size_t n = words.size() - i;
+    if (n > MAX_BIT) n = MAX_BIT;
+    for (size_t k = 0; k < MAX_BIT; ++k)
+      rows[k] = (k < n ? words[i + k] : 0);
+    transpose64(rows);
+    for (int p = 0; p < patterns; ++p)
+      unpackRow(rows[p], n, out + p * width + offset + i);
+  }
+}
 
 static bool parseSimError(CirSimError err) {
   cout << endl;
@@ -61,6 +137,97 @@ static void getlimit(const size_t& size) {
   if (size < 10) limit = 3;
   else limit = 5;
 }
+// Splits a stream into lines, reading it in large blocks.
+// Empty lines are skipped.
+class PatReader
+{
+public:
+  PatReader(istream& in) : _in(in), _buf(SIM_BUF_SIZE), _p(0), _end(0), _eof(false) {}
+  ~PatReader() {}
+
+  bool getLine(const char*& line, size_t& len) {
+    while (true) {
+      if (_p == _end) {
+        if (_eof) {
+          if (!_carry.size()) return false;
+          _line.swap(_carry); _carry.clear();
+          line = _line.data(); len = _line.size();
+          return true;
+        }
+        _in.read(&_buf[0], _buf.size());
+        size_t n = _in.gcount();
+        _eof = (n < _buf.size());
+        _p = &_buf[0]; _end = _p + n;
+        continue;
+      }
+      const char* nl = (const char*)memchr(_p, '\n', _end - _p);
+      if (!nl) { _carry.append(_p, _end); _p = _end; continue; }
+      line = _p; len = nl - _p; _p = nl + 1;
+      if (_carry.size()) {
+        _carry.append(line, len);
+        _line.swap(_carry); _carry.clear();
+        line = _line.data(); len = _line.size();
+      }
+      if (len) return true;
+    }
+  }
+
+private:
+  istream&      _in;
+  vector<char>  _buf;
+  const char*   _p;
+  const char*   _end;
+  bool          _eof;
+  string        _carry;
+  string        _line;
+};
+
+// Packed binary pattern file (native byte order):
+//   "FRAIGPAT" | uint32 #PI | uint32 #PO | uint64 #patterns |
+//   then per 64 patterns, #PI words followed by #PO words,
+//   where bit p of a word is pattern p of that block.
+// Pattern files have #PO = 0; simulation logs carry the PO values.
+static const char binPatMagic[8] = { 'F', 'R', 'A', 'I', 'G', 'P', 'A', 'T' };
+#define BIN_PAT_HEADER 24
+
+void writeBinHeader(ostream& os, unsigned nPI, unsigned nPO, Simtype nPat) {
+  os.write(binPatMagic, 8);
+  os.write((const char*)&nPI, sizeof(unsigned));
+  os.write((const char*)&nPO, sizeof(unsigned));
+  os.write((const char*)&nPat, sizeof(Simtype));
+}
+
+// sets the pattern count of a log whose length was not known up front
+void patchBinHeader(ostream& os, Simtype nPat) {
+  os.seekp(BIN_PAT_HEADER - sizeof(Simtype));
+  os.write((const char*)&nPat, sizeof(Simtype));
+  os.seekp(0, ios::end);
+}
+
+// returns false (and rewinds) if the stream is not a binary pattern file
+static bool readBinHeader(istream& is, unsigned& nPI, unsigned& nPO, Simtype& nPat) {
+  char magic[8];
+  is.read(magic, 8);
+  if (is.gcount() != 8 || memcmp(magic, binPatMagic, 8) != 0) {
+    is.clear(); is.seekg(0);
+    return false;
+  }
+  is.read((char*)&nPI, sizeof(unsigned));
+  is.read((char*)&nPO, sizeof(unsigned));
+  is.read((char*)&nPat, sizeof(Simtype));
+  return bool(is);
+}
+
+static double wallTime() {
+  timeval tv;
+  gettimeofday(&tv, 0);
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+static inline Simtype patMask(int patterns) {
+  return (patterns >= MAX_BIT ? Simtype_MAX : ((Simtype(1) << patterns) - 1));
+}
+
 /************************************************/
 /*   Public member functions about Simulation   */
 /************************************************/
@@ -69,56 +236,220 @@ CirMgr::randomSim()
 {
    unsigned patcount = 0;
    leave = 20;
+   const bool budgeted = (_simBudgetPat || _simBudgetTime > 0 || _simBudgetStall);
+   _simStats.clear(); _simStop = "";
+   _simStart = _lastSample = wallTime();
+   _stallRounds = 0; _lastSplits = _splits;
+   bool fresh = false, exhaustive = false;
    if (!FECs.size()) {
      if (!InitFec()) return;
+     fresh = true;
+     loadPatStore(patcount);
      cout << '\r' << "Total #FEC Group = " << FECs.size() << flush;
-     while (_PI.size() > 1000) {
+     // few enough PIs to enumerate them all; the groups come out exact,
+     // unless one is over the work limit or a budget stops the enumeration
+     if (_PI.size() <= EXH_PI_MAX) exhaustive = exactSim(patcount);
+   }
+   // bulk rounds of full random simulation; without a budget, only for
+   // large circuits and until simEachFec sees the group count saturate
+   if (!exhaustive && !_simStop.size() && (budgeted || (fresh && _PI.size() > 1000))) {
+     while (true) {
        genPattern();
        sim();
        ++patcount;
        cout << '\r' << "Total #FEC Group = " << FECs.size() << flush;
-       if (simEachFec(FECs.size())) break;
+       if (simRound(patcount)) break;
+       if (!budgeted && simEachFec(FECs.size())) break;
      }
    }
-   for (size_t i = 0; i < FECs.size(); ++i) {
+   for (size_t i = 0; i < FECs.size() && !_simStop.size() && !exhaustive; ++i) {
      cout << '\r' << "Total #FEC Group = " << FECs.size() << flush;
      simFEC(i); ++patcount;
+     if (simRound(patcount)) break;
    }
+   if (!_simStop.size() && !exhaustive) {
+     guidedSim(patcount);
+     exactSim(patcount);
+   }
+   simRound(patcount, true);
    cout << '\r' << patcount*MAX_BIT << " patterns simulated." << endl;
-   FECsort();
+   if (_simStop.size()) cout << "Stopped by " << _simStop << " budget." << endl;
+   compactPatStore();
+   savePatStore();
    LinkFecToGate();
 }
 
+void
+CirMgr::setSimBudget(size_t patterns, double seconds, unsigned stall)
+{
+   _simBudgetPat = patterns; _simBudgetTime = seconds; _simBudgetStall = stall;
+}
+
+/*********************
+Round   Patterns  #FEC Group  Largest    Pat/sec
+==============================================
+    1         64           3        55    12800
+*********************/
+void
+CirMgr::printSimStats() const
+{
+   if (!_simStats.size()) return;
+   cout << setw(7) << right << "Round" << setw(11) << "Patterns"
+        << setw(12) << "#FEC Group" << setw(10) << "Largest"
+        << setw(12) << "Pat/sec" << setw(10) << "Time(s)" << endl;
+   cout << "==============================================================" << endl;
+   for (size_t i = 0; i < _simStats.size(); ++i) {
+      const SimRound& r = _simStats[i];
+      double dt = r.seconds - (i ? _simStats[i-1].seconds : 0);
+      size_t dp = r.patterns - (i ? _simStats[i-1].patterns : 0);
+      cout << setw(7) << r.round << setw(11) << r.patterns
+           << setw(12) << r.groups << setw(10) << r.largest
+           << setw(12) << (dt > 0 ? size_t(dp / dt) : 0)
+           << setw(10) << fixed << setprecision(3) << r.seconds << endl;
+   }
+   cout.unsetf(ios::fixed);
+   if (_simStop.size()) cout << "Stopped by " << _simStop << " budget." << endl;
+}
+
+// The file is read in large blocks. Every 64 patterns are packed as rows of
+// a 64x64 bit matrix per 64 PIs and transposed into the column-major words
+// of _simPat. A packed binary pattern file is loaded into _simPat directly.
 void
 CirMgr::fileSim(ifstream& patternFile)
 {
   if (!FECs.size()) {
     if (!InitFec()) return;
   }
-  string buf; _simPat.clear(); _patterns = 0;
+  unsigned nPI, nPO;
+  Simtype nPat;
+  if (readBinHeader(patternFile, nPI, nPO, nPat)) {
+    binFileSim(patternFile, nPI, nPO, nPat);
+    return;
+  }
+  const size_t nBlk = (_PI.size() + MAX_BIT - 1) / MAX_BIT;
+  _simPat.assign(_PI.size(), 0); _patterns = 0;
+  _patRows.assign(nBlk * MAX_BIT, 0);
   int count = 0;
-  while (getline(patternFile, buf)) {
-    if(buf == "") continue;
-    if (!checkSim(buf)) return;
-    ++_patterns;
-    if (!_simPat.size()) _simPat.resize(buf.size());
-    setSimPattern(buf);
-    if (_patterns == MAX_BIT) {
-      sim();
+  PatReader reader(patternFile);
+  const char* line;
+  size_t len;
+  while (reader.getLine(line, len)) {
+    if (!packPattern(line, len)) return;
+    if (++_patterns == MAX_BIT) {
+      flushPattern(); sim();
       Initsim(); ++count; _patterns = 0;
     }
   }
-  if (_patterns) sim();
+  if (_patterns) { flushPattern(); sim(); }
   cout << '\r' << count*MAX_BIT + _patterns << " patterns simulated." << endl;
-  FECsort();
   LinkFecToGate();
 }
 
+void
+CirMgr::setSimLog(ofstream *logFile, bool binary)
+{
+  if (_simLog != NULL && _simLogBin)
+    patchBinHeader(*_simLog, _logPatterns);
+  _simLog = logFile; _simLogBin = binary; _logPatterns = 0;
+  if (_simLog != NULL && _simLogBin)
+    writeBinHeader(*_simLog, _PI.size(), _PO.size(), 0);
+}
+
+// Converts a text pattern file (or text simulation log) into the packed
+// binary format, or a binary one back into text.
+bool
+convertPatFile(const string& inName, const string& outName)
+{
+  ifstream in(inName.c_str(), ios::in | ios::binary);
+  if (!in) { cerr << "Cannot open file \"" << inName << "\"!!" << endl; return false; }
+  ofstream out(outName.c_str(), ios::out | ios::binary);
+  if (!out) { cerr << "Cannot open file \"" << outName << "\"!!" << endl; return false; }
+
+  unsigned nPI, nPO;
+  Simtype nPat;
+  if (readBinHeader(in, nPI, nPO, nPat)) { // binary -> text
+    const size_t width = nPI + (nPO ? nPO + 1 : 0) + 1;
+    vector<Simtype> pi(nPI), po(nPO);
+    string lines;
+    for (Simtype done = 0; done < nPat; done += MAX_BIT) {
+      int n = (nPat - done >= MAX_BIT ? MAX_BIT : int(nPat - done));
+      in.read((char*)pi.data(), nPI * sizeof(Simtype));
+      in.read((char*)po.data(), nPO * sizeof(Simtype));
+      if (!in) { cerr << "Error: \"" << inName << "\" is truncated!!" << endl; return false; }
+      lines.assign(width * n, ' ');
+      unpackWords(pi, n, &lines[0], 0, width);
+      unpackWords(po, n, &lines[0], nPI + 1, width);
+      for (int p = 0; p < n; ++p) lines[p * width + width - 1] = '\n';
+      out.write(lines.data(), lines.size());
+    }
+    cout << nPat << " patterns converted to text." << endl;
+    return true;
+  }
+
+  // text -> binary; the PI/PO widths are taken from the first line
+  PatReader reader(in);
+  const char* line;
+  size_t len;
+  nPI = nPO = 0; nPat = 0;
+  vector<Simtype> rows, words;
+  int patterns = 0;
+  writeBinHeader(out, 0, 0, 0);
+  while (true) {
+    bool more = reader.getLine(line, len);
+    if (more) {
+      const char* sp = (const char*)memchr(line, ' ', len);
+      size_t pil = (sp ? sp - line : len), pol = (sp ? len - pil - 1 : 0);
+      if (!nPat) {
+        nPI = pil; nPO = pol;
+        rows.assign(((nPI + MAX_BIT - 1) / MAX_BIT + (nPO + MAX_BIT - 1) / MAX_BIT) * MAX_BIT, 0);
+        words.resize(nPI + nPO);
+      }
+      if (pil != nPI || pol != nPO) {
+        cerr << "Error: line " << nPat + 1 << " of \"" << inName
+             << "\" does not match the width of the first line!!" << endl;
+        return false;
+      }
+      size_t r = 0;
+      bool ok = true;
+      for (size_t i = 0; i < nPI; i += MAX_BIT, r += MAX_BIT)
+        ok &= packRow(line + i, (nPI - i > MAX_BIT ? MAX_BIT : nPI - i), rows[r + patterns]);
+      for (size_t i = 0; i < nPO; i += MAX_BIT, r += MAX_BIT)
+        ok &= packRow(sp + 1 + i, (nPO - i > MAX_BIT ? MAX_BIT : nPO - i), rows[r + patterns]);
+      if (!ok) {
+        cerr << "Error: line " << nPat + 1 << " of \"" << inName
+             << "\" contains a non-0/1 character!!" << endl;
+        return false;
+      }
+      ++nPat; ++patterns;
+    }
+    if (patterns == MAX_BIT || (!more && patterns)) {
+      size_t r = 0, w = 0;
+      for (size_t i = 0; i < nPI; i += MAX_BIT, r += MAX_BIT) {
+        transpose64(&rows[r]);
+        for (size_t k = 0; k < MAX_BIT && i + k < nPI; ++k) words[w++] = rows[r + k];
+      }
+      for (size_t i = 0; i < nPO; i += MAX_BIT, r += MAX_BIT) {
+        transpose64(&rows[r]);
+        for (size_t k = 0; k < MAX_BIT && i + k < nPO; ++k) words[w++] = rows[r + k];
+      }
+      out.write((const char*)words.data(), words.size() * sizeof(Simtype));
+      rows.assign(rows.size(), 0);
+      patterns = 0;
+    }
+    if (!more) break;
+  }
+  out.seekp(0);
+  writeBinHeader(out, nPI, nPO, nPat);
+  cout << nPat << " patterns converted to binary." << endl;
+  return true;
+}
+
 /*************************************************/
 /*   Private member functions about Simulation   */
 /*************************************************/
 inline void CirMgr::genPattern() {
    Initsim();
+   _patterns = MAX_BIT;
    for (size_t i = 0; i < _PI.size(); ++i) {
      Simtype test = Simtype(rnGen(0));
      for (int j = 0; j < 64; ++j) {
@@ -141,20 +472,20 @@ inline void CirMgr::simFEC(size_t& i) {
   else {
     genPattern();
     setPat();
+    _simValid = false; // only the cones of this group are evaluated
+    coneSim(i);
   }
-  size_t check = FECs.size();
-  for (size_t j = 0; j < FECs[i].size(); ++j) {
-    CirGate::setGlobalRef();
-    // cout << "check: " << FECs[i][j].second->getId() << endl;
-    FECs[i][j].second->sim();
-  }
+  unsigned id = FECs.id(i);
   updateFec(i);
-  if (check > FECs.size()) --i;
-  else if (FECnotChange[i] < limit) --i;
+  if (i >= FECs.size() || FECs.id(i) != id) --i; // the group is gone
+  else if (FECs.notChange(i) < limit) --i;
 }
 
+// only the PIs in the cone of the first member are changed,
+// so the new values are propagated by event-driven simulation
 inline void CirMgr::specialFECsim(const size_t& i) {
   vector<unsigned> InID;
+  GateList changed;
   CirGate::setGlobalRef();
   FECs[i][0].second->FindIn(InID);
   for (size_t k = 0; k < InID.size(); ++k) {
@@ -165,10 +496,361 @@ inline void CirMgr::specialFECsim(const size_t& i) {
     }
     _list[InID[k]]->setSim(test);
     assert(_list[InID[k]]->getType() == PI_GATE);
+    changed.push_back(_list[InID[k]]);
   }
+  eventSim(changed);
   limit = 3;
 }
 
+// Evaluates the union of the fanin cones of group i in one pass. The cone is
+// compiled once and kept until the netlist changes; groups only split during
+// simulation, so a group with the same first member is always covered by it.
+// It is recompiled when the group has shrunk to less than half, so the cost
+// follows the cone of the group rather than the one it came from.
+void CirMgr::coneSim(const size_t& i) {
+  if (!_dfs_done) DoDfs();
+  unsigned id = FECs[i][0].second->getId();
+  if (_coneProg.size() < _list.size()) _coneProg.resize(_list.size());
+  ConeProg* p = &_coneProg[id];
+  if (!p->members || p->stamp != _dfsStamp || FECs[i].size() * 2 < p->members) {
+    if (_coneOps > CONE_OPS_MAX) {
+      _coneProg.clear(); _coneProg.resize(_list.size()); _coneOps = 0;
+      p = &_coneProg[id];
+    }
+    _coneOps -= p->ops.size();
+    compileCone(FECs[i], *p);
+    _coneOps += p->ops.size();
+  }
+  evalCone(*p);
+}
+
+void CirMgr::evalCone(const ConeProg& p) {
+  const size_t nLeaf = p.leaves.size();
+  if (_coneVal.size() < nLeaf + p.ands.size()) _coneVal.resize(nLeaf + p.ands.size());
+  Simtype* val = &_coneVal[0];
+  for (size_t k = 0; k < nLeaf; ++k) val[k] = p.leaves[k]->value();
+  const unsigned* op = (p.ops.size() ? &p.ops[0] : 0);
+  for (size_t k = 0; k < p.ands.size(); ++k, op += 2) {
+    Simtype a = val[op[0] >> 1], b = val[op[1] >> 1];
+    if (op[0] & 1) a = ~a;
+    if (op[1] & 1) b = ~b;
+    val[nLeaf + k] = a & b;
+  }
+  for (size_t k = 0; k < p.ands.size(); ++k) p.ands[k]->setValue(val[nLeaf + k]);
+}
+
+void CirMgr::compileCone(const FecGrp& grp, ConeProg& p) {
+  p.members = grp.size(); p.stamp = _dfsStamp;
+  p.leaves.clear(); p.ands.clear(); p.ops.clear();
+  // iterative post-order DFS; _coneSlot (by gate id) is only read for the
+  // gates of this cone, which are all written here, so it is never cleared
+  if (_coneSlot.size() < _list.size()) _coneSlot.resize(_list.size());
+  vector<unsigned>& slot = _coneSlot;
+  CirGate::setGlobalRef();
+  GateList order, stack;
+  for (size_t j = 0; j < grp.size(); ++j) {
+    CirGate* g = grp[j].second;
+    if (g->isGlobalRef()) continue;
+    stack.push_back(g);
+    while (stack.size()) {
+      CirGate* t = stack.back();
+      if (!t->isAig()) {
+        stack.pop_back();
+        if (t->isGlobalRef()) continue;
+        t->setToGlobalRef();
+        slot[t->getId()] = p.leaves.size(); p.leaves.push_back(t);
+        continue;
+      }
+      if (t->isGlobalRef()) { stack.pop_back(); continue; }
+      CirGate* in0 = t->getfanin(0).gate(), *in1 = t->getfanin(1).gate();
+      if (!in0->isGlobalRef()) { stack.push_back(in0); continue; }
+      if (!in1->isGlobalRef()) { stack.push_back(in1); continue; }
+      stack.pop_back();
+      t->setToGlobalRef();
+      order.push_back(t);
+    }
+  }
+  const unsigned nLeaf = p.leaves.size();
+  for (size_t k = 0; k < order.size(); ++k) {
+    slot[order[k]->getId()] = nLeaf + k;
+    for (int f = 0; f < 2; ++f) {
+      CirGateV in = order[k]->getfanin(f);
+      p.ops.push_back((slot[in.gate()->getId()] << 1) | unsigned(in.isInv()));
+    }
+  }
+  p.ands.swap(order);
+}
+
+// Exhaustive simulation of the groups whose cone has at most EXH_PI_MAX PIs:
+// all 2^k input combinations of the cone are enumerated in blocks of 64, so
+// the groups that are left are exact and fraig merges them without SAT.
+// A group is skipped if its cone costs more than EXH_WORK_MAX word
+// operations or the pass would exceed EXH_TOTAL_MAX, and every block is a
+// round of the budgets of simRound(). Returns true if all groups are exact.
+bool CirMgr::exactSim(unsigned& patcount) {
+  vector<unsigned> ids;
+  for (size_t i = 0; i < FECs.size(); ++i)
+    if (!FECs.exact(FECs.id(i))) ids.push_back(FECs.id(i));
+  bool all = true;
+  size_t work = 0;
+  for (size_t i = 0; i < ids.size(); ++i) {
+    if (_simStop.size()) { all = false; break; }
+    if (!exhaustGroup(ids[i], patcount, work)) all = false;
+  }
+  FECs.compact();
+  return all;
+}
+
+// returns false if the group is skipped or a budget stops its enumeration
+bool CirMgr::exhaustGroup(unsigned id, unsigned& patcount, size_t& work) {
+  static const Simtype lane[6] = {
+    0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+    0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL };
+  if (FECs.group(id).size() < 2) return true;
+  ConeProg p;
+  compileCone(FECs.group(id), p);
+  GateList sup;
+  for (size_t k = 0; k < p.leaves.size(); ++k)
+    if (p.leaves[k]->getType() == PI_GATE) sup.push_back(p.leaves[k]);
+  if (sup.size() > EXH_PI_MAX) return false;
+  const size_t rounds = size_t(1) << (sup.size() > 6 ? sup.size() - 6 : 0);
+  const size_t cost = rounds * (p.ops.size() / 2 + 1);
+  if (cost > EXH_WORK_MAX || work + cost > EXH_TOTAL_MAX) return false;
+  work += cost;
+
+  for (size_t k = 0; k < sup.size() && k < 6; ++k) sup[k]->setSim(lane[k]);
+  const unsigned first = FECs.numIds();
+  _simValid = false;
+  if (_exhPhase.size() < _list.size()) _exhPhase.resize(_list.size());
+  for (size_t r = 0; r < rounds; ++r) {
+    for (size_t k = 6; k < sup.size(); ++k)
+      sup[k]->setSim(((r >> (k - 6)) & 1) ? ~Simtype(0) : Simtype(0));
+    evalCone(p);
+    ++patcount;
+    // the phase of a gate is its value under the all-0 input (lane 0 of
+    // round 0), so that the keys of all rounds agree
+    if (r == 0) {
+      FecGrp g = FECs.group(id);
+      for (size_t j = 0; j < g.size(); ++j)
+        _exhPhase[g[j].second->getId()] = (g[j].second->value() & 1);
+    }
+    // the group and the ones split from it, which get ids from first on
+    if (FECs.refineId(id, &_exhPhase)) ++_splits;
+    for (unsigned c = first; c < FECs.numIds(); ++c)
+      if (FECs.refineId(c, &_exhPhase)) ++_splits;
+    // the splits so far are real, but the groups are not exact yet
+    if (simRound(patcount) && r + 1 < rounds) return false;
+  }
+  FECs.setExact(id);
+  for (unsigned c = first; c < FECs.numIds(); ++c) FECs.setExact(c);
+  return true;
+}
+
+// Targets the FEC groups that survived random simulation, largest first.
+// Every round spends 64 patterns on one pair of the group: half of them are
+// distance-1 perturbations of a known distinguishing pattern, the other half
+// are justified backward from the pair so that the two gates disagree.
+void CirMgr::guidedSim(unsigned& patcount) {
+  if (!FECs.size()) return;
+  vector<int> piIdx(_list.size(), -1);
+  for (size_t i = 0; i < _PI.size(); ++i) piIdx[_PI[i]->getId()] = i;
+  vector<int> tries(_list.size(), 0); // by the id of the first member
+  for (int round = 0; round < GUIDE_ROUND; ++round) {
+    int best = -1;
+    for (size_t i = 0; i < FECs.size(); ++i) {
+      if (tries[FECs[i][0].second->getId()] >= GUIDE_TRY) continue;
+      if (best == -1 || FECs[i].size() > FECs[best].size()) best = i;
+    }
+    if (best == -1) break;
+    ++tries[FECs[best][0].second->getId()];
+    if (!genGuidedPattern(best, piIdx)) continue;
+    updateFec(); ++patcount;
+    if (simRound(patcount)) break;
+  }
+}
+
+// returns false if the pair has no PI in its support
+bool CirMgr::genGuidedPattern(const size_t& i, const vector<int>& piIdx) {
+  CirGate* a = FECs[i][0].second;
+  size_t k = 1 + rnGen(FECs[i].size() - 1);
+  CirGate* b = FECs[i][k].second;
+  bool inv = (FECs[i][0].first.isInv() != FECs[i][k].first.isInv());
+
+  vector<unsigned> sup;
+  CirGate::setGlobalRef();
+  a->FindIn(sup); b->FindIn(sup);
+  if (!sup.size()) return false;
+
+  // lanes [0, 32): distance-1 perturbations
+  vector<Simtype> words(sup.size(), 0);
+  const vector<Simtype>* base = (_distPat.size() ? &_distPat[rnGen(_distPat.size())] : 0);
+  for (size_t s = 0; s < sup.size(); ++s) {
+    int pi = piIdx[sup[s]];
+    bool bit = (base ? ((*base)[pi / MAX_BIT] >> (pi % MAX_BIT)) & 1 : rnGen(2));
+    if (bit) words[s] = 0x00000000ffffffffULL;
+  }
+  for (int lane = 1; lane < 32; ++lane)
+    words[rnGen(sup.size())] ^= (Simtype(1) << lane);
+
+  // lanes [32, 64): backward justification of a != b (up to phase)
+  if (_justVal.size() != _list.size()) _justVal.assign(_list.size(), 0);
+  vector<unsigned> touched;
+  for (int lane = 32; lane < MAX_BIT; ++lane) {
+    bool va = (a->getType() == CONST_GATE ? false : rnGen(2));
+    justify(a, va, touched);
+    justify(b, va ^ inv ^ true, touched);
+    for (size_t s = 0; s < sup.size(); ++s) {
+      char v = _justVal[sup[s]];
+      if (v ? v == 2 : rnGen(2)) words[s] |= (Simtype(1) << lane);
+    }
+    for (size_t t = 0; t < touched.size(); ++t) _justVal[touched[t]] = 0;
+    touched.clear();
+  }
+
+  GateList changed;
+  for (size_t s = 0; s < sup.size(); ++s) {
+    _list[sup[s]]->setSim(words[s]);
+    changed.push_back(_list[sup[s]]);
+  }
+  eventSim(changed);
+  return true;
+}
+
+// Assigns value v to g and recursively to the fanins needed to imply it.
+// A gate keeps its first assignment; conflicts are left to simulation.
+void CirMgr::justify(CirGate* g, bool v, vector<unsigned>& touched) {
+  unsigned id = g->getId();
+  if (_justVal[id]) return;
+  _justVal[id] = (v ? 2 : 1);
+  touched.push_back(id);
+  if (g->getType() != AIG_GATE) return;
+  CirGateV in0 = g->getfanin(0), in1 = g->getfanin(1);
+  if (v) {
+    justify(in0.gate(), !in0.isInv(), touched);
+    justify(in1.gate(), !in1.isInv(), touched);
+    return;
+  }
+  // a 0 on either fanin suffices; prefer the one already at 0
+  char want0 = (in0.isInv() ? 2 : 1), want1 = (in1.isInv() ? 2 : 1);
+  if (_justVal[in0.gate()->getId()] == want0) return;
+  if (_justVal[in1.gate()->getId()] == want1) return;
+  CirGateV in = (rnGen(2) ? in0 : in1);
+  justify(in.gate(), in.isInv(), touched);
+}
+
+// keeps the PI assignment of the lowest lane set in "diff"
+inline void CirMgr::recordDist(const Simtype& diff) {
+  if (!diff) return;
+  unsigned lane = __builtin_ctzll(diff);
+  vector<Simtype> row((_PI.size() + MAX_BIT - 1) / MAX_BIT, 0);
+  for (size_t i = 0; i < _PI.size(); ++i)
+    if ((_PI[i]->value() >> lane) & Simtype(KEY))
+      row[i / MAX_BIT] |= (Simtype(KEY) << (i % MAX_BIT));
+  if (_distPat.size() < DIST_PAT_MAX) _distPat.push_back(row);
+  else _distPat[_distNext++ % DIST_PAT_MAX].swap(row);
+}
+
+// Called after every simulation round: keeps the stall counter, samples the
+// telemetry and returns true once a budget of CIRSIMulate -Random is used up.
+// Samples are taken on a split or when forced, but never closer than
+// STAT_GAP seconds or STAT_RATIO of the elapsed time, so long runs only
+// record a logarithmic number of rows.
+bool CirMgr::simRound(const unsigned& patcount, bool force) {
+  bool split = (_splits != _lastSplits);
+  if (split) { _stallRounds = 0; _lastSplits = _splits; }
+  else ++_stallRounds;
+  double now = wallTime(), gap = (now - _simStart) * STAT_RATIO;
+  if (gap < STAT_GAP) gap = STAT_GAP;
+  if (force || !_simStats.size() || (split && now - _lastSample >= gap)) {
+    SimRound r;
+    r.round = patcount; r.patterns = size_t(patcount) * MAX_BIT;
+    r.groups = FECs.size(); r.largest = 0;
+    for (size_t i = 0; i < FECs.size(); ++i)
+      if (FECs[i].size() > r.largest) r.largest = FECs[i].size();
+    r.seconds = now - _simStart;
+    if (!_simStats.size() || _simStats.back().round != r.round) _simStats.push_back(r);
+    _lastSample = now;
+  }
+  if (_simStop.size()) return true;
+  if (_simBudgetPat && size_t(patcount) * MAX_BIT >= _simBudgetPat) _simStop = "pattern";
+  else if (_simBudgetTime > 0 && now - _simStart >= _simBudgetTime) _simStop = "time";
+  else if (_simBudgetStall && _stallRounds >= _simBudgetStall) _simStop = "stall";
+  return _simStop.size();
+}
+
+/*************************************************/
+/*   Distinguishing-pattern store                */
+/*************************************************/
+// Every simulation round that splits a FEC group adds its PI words to
+// _patStore. The store is compacted and saved as a binary pattern file
+// next to the design ("<design>.fpat"), and replayed before the random
+// patterns of the next CIRSIMulate -Random on the same design.
+void CirMgr::recordWord() {
+  if (!_recordPat) return;
+  vector<Simtype> word(_PI.size());
+  for (size_t i = 0; i < _PI.size(); ++i) word[i] = _PI[i]->value();
+  _patStore.push_back(word);
+}
+
+// replays the stored words on a fresh partition and keeps the words that
+// still split a group; the resulting partition is the same as with all words
+void CirMgr::compactPatStore() {
+  if (!_patStore.size()) return;
+  FecStore savedFec; savedFec.swap(FECs);
+  vector<int> savedErr = Err;
+  _recordPat = false;
+  size_t keep = 0;
+  if (InitFec()) {
+    for (size_t w = 0; w < _patStore.size(); ++w) {
+      for (size_t i = 0; i < _PI.size(); ++i) _PI[i]->setSim(_patStore[w][i]);
+      CirGate::setGlobalRef();
+      for (size_t i = 0; i < _PO.size(); ++i) _PO[i]->sim();
+      if (!updateFec()) continue;
+      if (keep != w) _patStore[keep].swap(_patStore[w]);
+      ++keep;
+    }
+    _simValid = true;
+  }
+  _patStore.resize(keep);
+  _recordPat = true;
+  FECs.swap(savedFec); Err = savedErr;
+}
+
+void CirMgr::savePatStore() {
+  if (!_patStore.size() || !_fileName.size()) return;
+  string name = _fileName + ".fpat";
+  ofstream out(name.c_str(), ios::out | ios::binary);
+  if (!out) return;
+  writeBinHeader(out, _PI.size(), 0, Simtype(_patStore.size()) * MAX_BIT);
+  for (size_t w = 0; w < _patStore.size(); ++w)
+    out.write((const char*)_patStore[w].data(), _PI.size() * sizeof(Simtype));
+  cout << _patStore.size() << " distinguishing pattern words saved to \""
+       << name << "\"." << endl;
+}
+
+// the store of a previous run is simulated first; words that no longer
+// split anything are dropped by the next compaction
+void CirMgr::loadPatStore(unsigned& patcount) {
+  _patStore.clear();
+  if (!_fileName.size()) return;
+  string name = _fileName + ".fpat";
+  ifstream in(name.c_str(), ios::in | ios::binary);
+  unsigned nPI, nPO;
+  Simtype nPat;
+  if (!in || !readBinHeader(in, nPI, nPO, nPat)) return;
+  if (nPI != _PI.size() || nPO != 0) {
+    cout << "Note: \"" << name << "\" does not match the circuit; ignored." << endl;
+    return;
+  }
+  _simPat.resize(_PI.size());
+  for (Simtype done = 0; done < nPat; done += MAX_BIT) {
+    in.read((char*)_simPat.data(), nPI * sizeof(Simtype));
+    if (!in) break;
+    _patterns = MAX_BIT;
+    sim(); ++patcount;
+  }
+}
+
 bool CirMgr::checkSim(const string& buf) {
   if (buf.size() != _PI.size()) {
     errPat = buf; correct_num = _PI.size();
@@ -207,11 +889,44 @@ void CirMgr::sim() {
   for (size_t i = 0; i < _PO.size(); ++i) {
     _simResult[i] = (_PO[i]->sim());
   }
+  _simValid = true;
   if(_simLog != NULL) SimWrite();
   updateFec();
   cout << '\r' << "Total #FEC Group = " << FECs.size() << flush;
 }
 
+// Event-driven re-simulation: the PIs in "changed" already hold their new
+// values. Only the gates whose value actually changes propagate further,
+// level by level. Falls back to a full evaluation if the stored gate values
+// are not consistent with the current PIs.
+void CirMgr::eventSim(const GateList& changed) {
+  if (!_dfs_done) DoDfs();
+  CirGate::setGlobalRef();
+  if (!_simValid) {
+    for (size_t i = 0; i < _PO.size(); ++i) _PO[i]->sim();
+    _simValid = true;
+    return;
+  }
+  if (_eventQ.size() != _maxLevel + 1) _eventQ.resize(_maxLevel + 1);
+  for (size_t i = 0; i < changed.size(); ++i)
+    scheduleFanout(changed[i]);
+  for (size_t lv = 1; lv <= _maxLevel; ++lv) {
+    GateList& q = _eventQ[lv];
+    for (size_t j = 0; j < q.size(); ++j)
+      if (q[j]->resim()) scheduleFanout(q[j]);
+    q.clear();
+  }
+}
+
+inline void CirMgr::scheduleFanout(CirGate* g) {
+  for (size_t i = 0, n = g->fanoutNO(); i < n; ++i) {
+    CirGate* out = g->getfanout(i).gate();
+    if (out->isGlobalRef() || !out->InDfs()) continue;
+    out->setToGlobalRef();
+    _eventQ[out->getLevel()].push_back(out);
+  }
+}
+
 inline void CirMgr::Initsim() {
   if (_simPat.size() != _PI.size()) _simPat.resize(_PI.size());
   for (size_t i = 0; i < _simPat.size(); ++i)
@@ -220,16 +935,56 @@ inline void CirMgr::Initsim() {
     _simResult[i] = 0;
 }
 
-inline void CirMgr::setSimPattern(const string& buf) {
-  for (size_t i = 0; i < buf.size(); ++i) {
-    Simtype tmp = buf[i] - '0';
-    _simPat[i] += (tmp << _patterns-1);
+inline void CirMgr::binFileSim(ifstream& patternFile, unsigned nPI, unsigned nPO, Simtype nPat) {
+  if (nPI != _PI.size()) {
+    cerr << "Error: Binary pattern file has " << nPI << " inputs but the circuit has "
+         << _PI.size() << "!!" << endl;
+    cout << "0 patterns simulated." << endl;
+    return;
+  }
+  _simPat.assign(_PI.size(), 0);
+  vector<Simtype> skip(nPO);
+  Simtype done = 0;
+  for (; done < nPat; done += _patterns) {
+    _patterns = (nPat - done >= MAX_BIT ? MAX_BIT : int(nPat - done));
+    patternFile.read((char*)_simPat.data(), nPI * sizeof(Simtype));
+    patternFile.read((char*)skip.data(), nPO * sizeof(Simtype));
+    if (!patternFile) {
+      cerr << "Error: Binary pattern file is truncated!!" << endl;
+      break;
+    }
+    sim();
+  }
+  cout << '\r' << done << " patterns simulated." << endl;
+  LinkFecToGate();
+}
+
+// stores the pattern as row _patterns of every PI block;
+// falls back to checkSim() for the error message
+inline bool CirMgr::packPattern(const char* buf, size_t len) {
+  if (len != _PI.size()) return checkSim(string(buf, len));
+  for (size_t b = 0, i = 0; i < len; ++b, i += MAX_BIT) {
+    size_t n = len - i;
+    if (n > MAX_BIT) n = MAX_BIT;
+    if (!packRow(buf + i, n, _patRows[b * MAX_BIT + _patterns]))
+      return checkSim(string(buf, len));
+  }
+  return true;
+}
+
+inline void CirMgr::flushPattern() {
+  for (size_t b = 0, i = 0; i < _PI.size(); ++b, i += MAX_BIT) {
+    Simtype* rows = &_patRows[b * MAX_BIT];
+    transpose64(rows);
+    for (size_t k = 0; k < MAX_BIT && i + k < _PI.size(); ++k)
+      _simPat[i + k] = rows[k];
+    memset(rows, 0, MAX_BIT * sizeof(Simtype));
   }
 }
 
 inline bool CirMgr::InitFec() {
+  _coneProg.clear(); _coneOps = 0;
   FECs.clear();
-  FECnotChange.clear();
   Err.clear();
   if (!_dfs_done) DoDfs();
   SimKey k(0);
@@ -239,132 +994,77 @@ inline bool CirMgr::InitFec() {
     newFec.push_back(SimNode(k, _dfsList[i]));
   }
   newFec.push_back(SimNode(0, _list[0]));
-  if (newFec.size() > 1) {
-    FECs.push_back(newFec);
-    FECnotChange.push_back(0);
-    return true;
-  } return false;
+  FECs.init(newFec);
+  return FECs.size();
 }
 
-inline void CirMgr::updateFec(int id) {
-    HashMap<SimKey, CirGate*> newGrps(getHashSize(FECs[id].size()));
+inline bool CirMgr::updateFec(int id) {
+    FecGrp grp = FECs[id];
     // check if fec has different values
     bool insert = false;
-    FECs[id][0].first.update(FECs[id][0].second->value());
-    Simtype boost = (FECs[id][0].first)();
-    for (size_t j = 1; j < FECs[id].size(); ++j) {
-      FECs[id][j].first.update(FECs[id][j].second->value());
-      if ((FECs[id][j].first)() != boost && (FECs[id][j].first)() != ~boost) insert = true;
-    }
-    if (!insert) { ++FECnotChange[id]; return;}
-    for (size_t j = 0; j < FECs[id].size(); ++j) {
-      newGrps.insert(FECs[id][j]);
-    }
-    vector<FEC> valid;
-    newGrps.valid(valid); // collecting valid groups
-    
-    if (valid.size()) { FECs[id] = valid[0]; FECnotChange[id] = 0; }
-    else {
-      // vector<FEC>::iterator it = FECs.begin()+i;
-      // vector<int>::iterator itt = FECnotChange.begin()+i;
-      // FECs.erase(it); --i; FECnotChange.erase(itt);
-      FECs[id] = FECs[FECs.size()-1]; FECs.pop_back();
-      FECnotChange[id] = FECnotChange[FECnotChange.size()-1]; FECnotChange.pop_back();
-      --id;
-    }
-    
-    for (size_t k = 1; k < valid.size(); ++k) {
-      // FECs.push_back(valid[k]); FECnotChange.push_back(0);
-      FECs.insert(FECs.begin()+id+1, valid[k]);
-      FECnotChange.insert(FECnotChange.begin()+id+1, 0); ++id;
+    grp[0].first.update(grp[0].second->value());
+    Simtype boost = (grp[0].first)();
+    for (size_t j = 1; j < grp.size(); ++j) {
+      grp[j].first.update(grp[j].second->value());
+      if ((grp[j].first)() != boost && (grp[j].first)() != ~boost) {
+        if (!insert) recordDist((grp[j].first)() ^ boost);
+        insert = true;
+      }
     }
+    if (!insert) { ++FECs.notChange(id); return false; }
+    recordWord(); ++_splits;
+    FECs.split(id); // a group that is gone is replaced by the last one
+    return true;
 }
 
-inline void CirMgr::updateFec() {
-  for (size_t i = 0; i < FECs.size(); ++i) {
-    HashMap<SimKey, CirGate*> newGrps(getHashSize(FECs[i].size()));
-    // check if fec has different values
-    bool insert = false;
-    FECs[i][0].first.update(FECs[i][0].second->value());
-    Simtype boost = (FECs[i][0].first)();
-    for (size_t j = 1; j < FECs[i].size(); ++j) {
-      FECs[i][j].first.update(FECs[i][j].second->value());
-      if ((FECs[i][j].first)() != boost && (FECs[i][j].first)() != ~boost) insert = true;
-    }
-    if (!insert) { ++FECnotChange[i]; continue; }
-    for (size_t j = 0; j < FECs[i].size(); ++j) {
-      newGrps.insert(FECs[i][j]);
-    }
-    vector<FEC> valid;
-    newGrps.valid(valid); // collecting valid groups
-
-    if (valid.size()) { FECs[i] = valid[0]; FECnotChange[i] = 0; }
-    else {
-      // vector<FEC>::iterator it = FECs.begin()+i;
-      // vector<int>::iterator itt = FECnotChange.begin()+i;
-      // FECs.erase(it); --i; FECnotChange.erase(itt);
-      FECs[i] = FECs[FECs.size()-1]; FECs.pop_back();
-      FECnotChange[i] = FECnotChange[FECnotChange.size()-1]; FECnotChange.pop_back();
-      --i;
-    }
-    
-    for (size_t k = 1; k < valid.size(); ++k) {
-      // FECs.push_back(valid[k]); FECnotChange.push_back(0);
-      FECs.insert(FECs.begin()+i+1, valid[k]);
-      FECnotChange.insert(FECnotChange.begin()+i+1, 0); ++i;
-    }
-  }
+inline bool CirMgr::updateFec() {
+  _fecDiff.clear();
+  if (!FECs.refine(_fecDiff)) return false;
+  recordWord();
+  _splits += _fecDiff.size();
+  for (size_t i = 0; i < _fecDiff.size(); ++i) recordDist(_fecDiff[i]);
+  return true;
 }
 
 void CirMgr::LinkFecToGate() {
-  for (size_t i = 0; i < FECs.size(); ++i) {
-    FEC* f = &FECs[i];
-    for (size_t j = 0; j < FECs[i].size(); ++j) {
-      FECs[i][j].second->setFec(f, i);
-    }
-  }
+  for (size_t i = 0; i < _dfsList.size(); ++i)
+    _dfsList[i]->resetFEC();
+  _list[0]->resetFEC();
+  FECs.renumber();
 }
 
+// Transposes the PI and PO words back into one text line per pattern
 void CirMgr::SimWrite() {
-  char* endline = new char('\n');
-  char* space = new char(' ');
-  char* tmp = new char[_simPat.size()];
-  char* tmp1 = new char[_simResult.size()];
-  for (int i = _patterns; i > 0; --i) {
-    for (size_t j = 0; j < _simPat.size(); ++j) { 
-      Simtype keyed = _simPat[j] & Simtype(KEY);
-      _simPat[j] = _simPat[j] >> 1;
-      tmp[j] = (keyed) + '0';
-    }
-    _simLog->write(tmp, _simPat.size());
-    _simLog->write(space, 1);
-    for (size_t k = 0; k < _simResult.size(); ++k) {
-      Simtype keyedcode = _simResult[k] & Simtype(KEY);
-      _simResult[k] = _simResult[k] >> 1;
-      tmp1[k] = (keyedcode + '0');      
-    }
-    _simLog->write(tmp1, _simResult.size());
-    _simLog->write(endline, 1);
+  const size_t nPI = _simPat.size(), nPO = _simResult.size();
+  if (_simLogBin) {
+    const Simtype mask = patMask(_patterns);
+    logBuf.resize((nPI + nPO) * sizeof(Simtype));
+    Simtype* words = (Simtype*)&logBuf[0];
+    for (size_t i = 0; i < nPI; ++i) words[i] = _simPat[i] & mask;
+    for (size_t i = 0; i < nPO; ++i) words[nPI + i] = _simResult[i] & mask;
+    _simLog->write(logBuf.data(), logBuf.size());
+    _logPatterns += _patterns;
+    return;
+  }
+  const size_t width = nPI + nPO + 2;
+  logBuf.resize(width * _patterns);
+  char* out = &logBuf[0];
+  for (int p = 0; p < _patterns; ++p) {
+    out[p * width + nPI] = ' ';
+    out[p * width + width - 1] = '\n';
   }
-  delete endline; delete space; delete tmp; delete tmp1;
+  unpackWords(_simPat, _patterns, out, 0, width);
+  unpackWords(_simResult, _patterns, out, nPI + 1, width);
+  _simLog->write(out, logBuf.size());
 }
 
-inline void CirMgr::FECsort() {
-  if (FECs.size() == 0) return;
-  for (size_t i = 0; i < FECs.size(); ++i) {
-    for (size_t j = 0; j < FECs[i].size()-1; ++j) {
-      for (size_t k = j+1; k < FECs[i].size(); ++k) {
-        if (FECs[i][j].second->getId() > FECs[i][k].second->getId())
-          ::swap(FECs[i][j], FECs[i][k]);
-      }
-    }
-  }
-  for (size_t i = 0; i < FECs.size()-1; ++i) {
-    for (size_t j = i+1; j < FECs.size(); ++j) {
-      if (FECs[i][0].second->getId() > FECs[j][0].second->getId())
-        ::swap(FECs[i], FECs[j]);
-    }
-  }
+// Groups are kept in simulation order; the canonical order (groups by
+// their smallest id, members by id) is made only when it is shown or
+// fraig needs it, and the gates are relinked to the new ids.
+void CirMgr::FECsort() {
+  if (FECs.sorted()) return;
+  FECs.sort();
+  FECs.renumber();
 }
 
 void CirMgr::testPI() {
@@ -0,0 +1,147 @@
+/****************************************************************************
+  FileName     [ cirSolver.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define the SAT solver of fraig ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2012-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <iostream>
+#include <cassert>
+#include "cirSolver.h"
+#include "cirGate.h"
+
+using namespace std;
+
+/*******************************/
+/*   Global variable and enum  */
+/*******************************/
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+
+/*******************************************/
+/*   class FraigSolver member functions    */
+/*******************************************/
+void FraigSolver::reset(size_t nIds) {
+  _s.initialize();
+  _var.assign(nIds, -1);
+  _retired = 0;
+}
+
+void FraigSolver::alias(const CirGate* h, CirGate* g, bool inv) {
+  if (_rep.size() < _var.size()) _rep.resize(_var.size());
+  _rep[h->getId()] = CirGateV(g, inv);
+}
+
+int FraigSolver::prove(CirGate* g, CirGate* h, bool inv) {
+  const Var vg = encode(g), vh = encode(h);
+  const Var act = _s.newVar();
+  _s.addMiterCNF(act, vg, false, vh, inv);
+  _s.assumeRelease();
+  _s.assumeProperty(act, true);
+  const int result = _s.assumpSolve(_budget, -1);
+  _s.retire(act); ++_retired;
+  return result;
+}
+
+int FraigSolver::value(const CirGate* g) const {
+  const Var v = _var[g->getId()];
+  return (v == -1 ? -1 : _s.getValue(v));
+}
+
+// Tseitin-encodes the part of the fanin cone of g that is not in the
+// solver yet; no CirGate is written, so solvers of other threads may
+// encode the same gates. PIs are free vars; CONST 0 and the UNDEF gates
+// are asserted false, as simulation takes an UNDEF gate to be 0.
+Var FraigSolver::encode(CirGate* g) {
+  if (_var[g->getId()] != -1) return _var[g->getId()];
+  _stack.push_back(g);
+  while (_stack.size()) {
+    CirGate* t = _stack.back();
+    if (_var[t->getId()] != -1) { _stack.pop_back(); continue; }
+    if (t->getType() != AIG_GATE) {
+      _var[t->getId()] = _s.newVar();
+      if (t->getType() == CONST_GATE || t->getType() == UNDEF_GATE)
+        _s.assertProperty(_var[t->getId()], false);
+      _stack.pop_back(); continue;
+    }
+    const CirGateV v0 = fanin(t, 0), v1 = fanin(t, 1);
+    if (_var[v0.gate()->getId()] == -1) _stack.push_back(v0.gate());
+    if (_var[v1.gate()->getId()] == -1) _stack.push_back(v1.gate());
+    if (_stack.back() != t) continue;
+    _stack.pop_back();
+    const Var v = _s.newVar();
+    _var[t->getId()] = v;
+    _s.addAigCNF(v, _var[v0.gate()->getId()], v0.isInv(), _var[v1.gate()->getId()], v1.isInv());
+  }
+  return _var[g->getId()];
+}
+
+// fanin i of g, or the gate it is an alias of
+inline CirGateV FraigSolver::fanin(CirGate* g, int i) const {
+  const CirGateV v = g->getfanin(i);
+  if (v.gate()->getId() >= _rep.size()) return v;
+  const CirGateV r = _rep[v.gate()->getId()];
+  if (!r.gate()) return v;
+  return CirGateV(r.gate(), r.isInv() != v.isInv());
+}
+
+/*******************************************/
+/*   class WindowSolver member functions   */
+/*******************************************/
+int WindowSolver::prove(CirGate* g, CirGate* h, bool inv) {
+  _win.clear();
+  size_t gates = 0;
+  bool cut = false;
+  // breadth first from the pair; _win is the queue
+  CirGate* root[2] = { g, h };
+  for (int i = 0; i < 2; ++i) {
+    const unsigned id = root[i]->getId();
+    if (_var.size() <= id) _var.resize(id + 1, -1);
+    if (_var[id] == -1) { _var[id] = -2; _win.push_back(root[i]); }
+  }
+  for (size_t q = 0; q < _win.size(); ++q) {
+    CirGate* t = _win[q];
+    if (t->getType() != AIG_GATE) continue;
+    if (gates == WINDOW_GATES) { cut = true; continue; } // a leaf
+    ++gates;
+    for (int i = 0; i < 2; ++i) {
+      CirGate* f = t->getfanin(i).gate();
+      if (_var.size() <= f->getId()) _var.resize(f->getId() + 1, -1);
+      if (_var[f->getId()] != -1) continue;
+      _var[f->getId()] = -2;
+      _win.push_back(f);
+    }
+  }
+  int result = -1;
+  if (cut) {
+    _s.initialize();
+    // the first "gates" AIG gates of the queue are the window
+    size_t n = 0;
+    for (size_t q = 0; q < _win.size(); ++q) {
+      CirGate* t = _win[q];
+      if (t->getType() != AIG_GATE || n++ >= gates) continue;
+      const CirGateV v0 = t->getfanin(0), v1 = t->getfanin(1);
+      _s.addAigCNF(var(t), var(v0.gate()), v0.isInv(), var(v1.gate()), v1.isInv());
+    }
+    const Var act = _s.newVar();
+    _s.addMiterCNF(act, var(g), false, var(h), inv);
+    _s.assumeRelease();
+    _s.assumeProperty(act, true);
+    if (_s.assumpSolve(_budget, -1) == 0) result = 0;
+  }
+  for (size_t q = 0; q < _win.size(); ++q) _var[_win[q]->getId()] = -1;
+  return result;
+}
+
+// the var of t in the solver of the window; CONST 0 and the UNDEF gates
+// are asserted false, as in FraigSolver
+inline Var WindowSolver::var(CirGate* t) {
+  Var& v = _var[t->getId()];
+  if (v >= 0) return v;
+  v = _s.newVar();
+  if (t->getType() == CONST_GATE || t->getType() == UNDEF_GATE) _s.assertProperty(v, false);
+  return v;
+}
@@ -0,0 +1,97 @@
+/****************************************************************************
+  FileName     [ cirSolver.h ]
+  PackageName  [ cir ]
+  Synopsis     [ Define the SAT solver of fraig ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2012-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#ifndef CIR_SOLVER_H
+#define CIR_SOLVER_H
+
+#include <vector>
+#include "cirDef.h"
+#include "sat.h"
+
+using namespace std;
+
+// A SatSolver with its own map from gate ids to vars, so that several of
+// them can encode the same circuit at once. The fanin cones are encoded
+// lazily, as the proofs reach them, and the miter of each proof is
+// guarded by an activation var that is retired after the query.
+class FraigSolver
+{
+public:
+  FraigSolver() : _retired(0), _budget(-1) {}
+  ~FraigSolver() {}
+
+  // an empty solver for the gates with ids below nIds
+  void reset(size_t nIds);
+  // From now on, a fanin h is read as g (inverted if inv) by the gates
+  // encoded, so the cones above a merged gate are encoded over the
+  // reduced circuit; h itself is still encoded from its own fanins. The
+  // aliases are kept by reset().
+  void alias(const CirGate* h, CirGate* g, bool inv);
+  // all aliases at once, by gate id, for a speculatively reduced circuit:
+  // then the members of an FEC group feed their fanouts with the
+  // representative, and each one is encoded from its own fanins only
+  // for its miter
+  void setAliases(const vector<CirGateV>& rep) { _rep = rep; }
+  void clearAliases() { _rep.clear(); }
+  // 0 if g and h (inverted if inv) are proven equal, 1 if they are not
+  // (the model is a pattern that tells them apart), -1 if the budget of
+  // conflicts runs out first
+  int prove(CirGate* g, CirGate* h, bool inv);
+  // conflicts per prove(); -1 for no limit. It is kept by reset().
+  void setBudget(int conflicts) { _budget = conflicts; }
+  // the value of g in the model, -1 if g is not encoded
+  int value(const CirGate* g) const;
+
+  unsigned retired() const { return _retired; }
+  int nLearnts() const { return _s.nLearnts(); }
+
+private:
+  SatSolver         _s;
+  vector<Var>       _var;      // by gate id; -1 if not encoded
+  vector<CirGateV>  _rep;      // the aliases by gate id
+  GateList          _stack;    // scratch of encode()
+  unsigned          _retired;  // #miters retired since reset()
+  int               _budget;
+
+  Var encode(CirGate*);
+  CirGateV fanin(CirGate* g, int i) const;
+};
+
+// the stages of a fraig proof: a pair is decided by the first that can
+enum ProveStage { PROVE_TRUTH, PROVE_WINDOW, PROVE_SAT };
+
+// at most this many AIG gates in the window of a pair
+#define WINDOW_GATES 64
+
+// Proves a pair over a window of its cones: the AIG gates closest to the
+// pair, breadth first, with the fanins outside the window taken as free
+// vars. Equal over the window means equal, as the window leaves can take
+// any values; different may be due to the free leaves only. A small
+// solver of its own is built for each pair.
+class WindowSolver
+{
+public:
+  WindowSolver() : _budget(-1) {}
+  ~WindowSolver() {}
+
+  // 0 if g and h (inverted if inv) are proven equal over the window, -1
+  // otherwise, or if the window covers both cones (the full proof is not
+  // more expensive then)
+  int prove(CirGate* g, CirGate* h, bool inv);
+  void setBudget(int conflicts) { _budget = conflicts; }
+
+private:
+  SatSolver         _s;
+  vector<Var>       _var;      // by gate id; -1 if not in the window
+  GateList          _win;      // the window, with the leaves after the gates
+  int               _budget;
+
+  Var var(CirGate*);
+};
+
+#endif // CIR_SOLVER_H
@@ -0,0 +1,154 @@
+/****************************************************************************
+  FileName     [ cirStream.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define out-of-core streaming simulation of a circuit image ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <iostream>
+#include <cassert>
+#include "cirStream.h"
+#include "cirMgr.h"
+#include "util.h"
+
+using namespace std;
+
+/*******************************/
+/*   Global variable and enum  */
+/*******************************/
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+#define STREAM_WORDS 64        // words simulated per pass over the netlist
+#define STREAM_DEAD  0xffffffff // _last of a gate nobody reads
+#define SIG_MUL      0x9e3779b97f4a7c15ULL
+
+// xorshift64*, seeded from rnGen; the patterns of one run are reproducible
+// from its seed only
+static Simtype rndState = 0;
+static inline Simtype rndWord() {
+  rndState ^= rndState >> 12; rndState ^= rndState << 25; rndState ^= rndState >> 27;
+  return rndState * 0x2545f4914f6cdd1dULL;
+}
+
+/******************************************/
+/*   class CirStreamSim member functions  */
+/******************************************/
+bool CirStreamSim::open(const string& image) {
+  if (!_img.open(image)) return false;
+  const unsigned M = _img.maxVar(), A = _img.numAnds();
+  for (unsigned k = 0; k < A; ++k) {
+    const unsigned id = _img.topo(k);
+    if (!id || id > M || _img.type(id) != AIG_GATE ||
+        _img.fanin(id, 0) / 2 > M || _img.fanin(id, 1) / 2 > M) {
+      cerr << "Error: circuit image \"" << image << "\" is corrupted!!" << endl;
+      _img.close();
+      return false;
+    }
+  }
+  analyze();
+  return true;
+}
+
+// fanout liveness: the last topological position that reads each gate;
+// the POs read at position A, after every AIG gate
+void CirStreamSim::analyze() {
+  const unsigned M = _img.maxVar(), A = _img.numAnds();
+  _last.assign(M + 1, STREAM_DEAD);
+  for (unsigned k = 0; k < A; ++k) {
+    const unsigned id = _img.topo(k);
+    _last[_img.fanin(id, 0) / 2] = k;
+    _last[_img.fanin(id, 1) / 2] = k;
+  }
+  for (unsigned i = 0; i < _img.numPOs(); ++i) _last[_img.po(i) / 2] = A;
+}
+
+unsigned CirStreamSim::alloc() {
+  if (++_live > _peak) _peak = _live;
+  if (_free.size()) { unsigned s = _free.back(); _free.pop_back(); return s; }
+  _val.resize(_val.size() + STREAM_WORDS);
+  return _val.size() / STREAM_WORDS - 1;
+}
+
+// Simulates the patterns in passes of STREAM_WORDS words. A signature is
+// folded from all words of a gate, with its phase fixed by the first
+// pattern, so equal signatures mean equal or inverted gates.
+void CirStreamSim::run(size_t patterns, ostream* log, ostream* sig) {
+  const unsigned M = _img.maxVar(), I = _img.numPIs(), O = _img.numPOs();
+  const unsigned A = _img.numAnds();
+  const size_t W = STREAM_WORDS, words = (patterns + 63) / 64;
+  rndState = (Simtype(rnGen(INT_MAX)) << 32) ^ rnGen(INT_MAX) ^ 1;
+
+  // slot 0 is CONST 0 (and any undefined gate), slots 1..I the PIs
+  _val.assign((I + 1) * W, 0);
+  _free.clear(); _live = _peak = 0;
+  _slot.assign(M + 1, 0);
+  for (unsigned i = 0; i < I; ++i) _slot[_img.pi(i)] = i + 1;
+  vector<Simtype> sigs(sig ? A : 0, 0);
+  vector<char> phase(sig ? A : 0, 0);
+  vector<Simtype> poVal(O);
+  if (log) writeBinHeader(*log, I, O, 0);
+
+  for (size_t done = 0; done < words; done += W) {
+    const size_t w = (words - done < W ? words - done : W);
+    for (unsigned i = 0; i < I; ++i)
+      for (size_t j = 0; j < w; ++j) _val[(i + 1) * W + j] = rndWord();
+    for (unsigned k = 0; k < A; ++k) {
+      const unsigned id = _img.topo(k);
+      const unsigned l0 = _img.fanin(id, 0), l1 = _img.fanin(id, 1);
+      const Simtype m0 = Simtype(0) - (l0 & 1), m1 = Simtype(0) - (l1 & 1);
+      const unsigned s = alloc();
+      // _val may have moved in alloc()
+      const Simtype* a = &_val[_slot[l0 / 2] * W];
+      const Simtype* b = &_val[_slot[l1 / 2] * W];
+      Simtype* v = &_val[s * W];
+      for (size_t j = 0; j < w; ++j) v[j] = (a[j] ^ m0) & (b[j] ^ m1);
+      if (sig) {
+        if (!done) phase[k] = (v[0] & 1);
+        const Simtype pm = Simtype(0) - Simtype(phase[k]);
+        for (size_t j = 0; j < w; ++j) sigs[k] = (sigs[k] ^ v[j] ^ pm) * SIG_MUL;
+      }
+      _slot[id] = s;
+      if (_last[l0 / 2] == k && _img.type(l0 / 2) == AIG_GATE) release(_slot[l0 / 2]);
+      if (_last[l1 / 2] == k && l1 / 2 != l0 / 2 && _img.type(l1 / 2) == AIG_GATE)
+        release(_slot[l1 / 2]);
+      if (_last[id] == STREAM_DEAD) release(s);
+    }
+    // POs, written word by word as the pass is done
+    for (size_t j = 0; j < w; ++j) {
+      for (unsigned i = 0; i < O; ++i) {
+        const unsigned l = _img.po(i);
+        poVal[i] = _val[_slot[l / 2] * W + j] ^ (Simtype(0) - (l & 1));
+      }
+      if (!log) continue;
+      for (unsigned i = 0; i < I; ++i) log->write((const char*)&_val[(i + 1) * W + j], sizeof(Simtype));
+      log->write((const char*)poVal.data(), O * sizeof(Simtype));
+    }
+    // an AIG gate never gets slot 0, so a cleared slot marks a driver of
+    // several POs as released
+    for (unsigned i = 0; i < O; ++i) {
+      const unsigned g = _img.po(i) / 2;
+      if (_img.type(g) == AIG_GATE && _slot[g]) { release(_slot[g]); _slot[g] = 0; }
+    }
+    assert(!_live);
+    cout << '\r' << (done + w) * 64 << " patterns simulated." << flush;
+  }
+  cout << endl;
+
+  if (log) patchBinHeader(*log, Simtype(words) * 64);
+  // signature file: uint64 #gates, then per AIG gate in topological
+  // order a uint32 literal (2 * id + phase) and a uint64 signature
+  if (sig) {
+    const Simtype n = A;
+    sig->write((const char*)&n, sizeof(Simtype));
+    for (unsigned k = 0; k < A; ++k) {
+      const unsigned lit = 2 * _img.topo(k) + phase[k];
+      sig->write((const char*)&lit, sizeof(unsigned));
+      sig->write((const char*)&sigs[k], sizeof(Simtype));
+    }
+  }
+  cout << "Peak live values: " << _peak << " of " << A << " AIG gates ("
+       << _val.size() * sizeof(Simtype) / 1024 << " KB)." << endl;
+}
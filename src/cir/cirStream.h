@@ -0,0 +1,51 @@
+/****************************************************************************
+  FileName     [ cirStream.h ]
+  PackageName  [ cir ]
+  Synopsis     [ Define out-of-core streaming simulation of a circuit image ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2008-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#ifndef CIR_STREAM_H
+#define CIR_STREAM_H
+
+#include <vector>
+#include <iostream>
+#include "cirDef.h"
+#include "cirImage.h"
+
+using namespace std;
+
+// Random simulation straight from a circuit image, without building any
+// CirGate. The AIG gates are visited in the topological order of the
+// image, and the value of a gate is kept in a slot of the value pool only
+// until its last reader (or the PO pass) is done; then the slot is reused.
+// The memory used is two words of liveness data per gate plus the peak
+// number of live values, while the netlist itself stays in the mapped
+// file and is paged in and out by the kernel.
+class CirStreamSim
+{
+public:
+  CirStreamSim() : _peak(0) {}
+  ~CirStreamSim() {}
+
+  bool open(const string& image);
+  // log gets the PI and PO words as a binary simulation log, sig the
+  // signatures of the AIG gates; either may be 0
+  void run(size_t patterns, ostream* log, ostream* sig);
+  size_t peakLive() const { return _peak; }
+
+private:
+  CirImage            _img;
+  vector<unsigned>    _last;   // topological position of the last reader, by id
+  vector<unsigned>    _slot;   // value slot, by id; slot 0 is CONST 0
+  vector<unsigned>    _free;
+  vector<Simtype>     _val;    // the value pool, STREAM_WORDS words per slot
+  size_t              _live, _peak;
+
+  void analyze();
+  unsigned alloc();
+  void release(unsigned s) { _free.push_back(s); --_live; }
+};
+
+#endif // CIR_STREAM_H
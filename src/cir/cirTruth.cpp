@@ -0,0 +1,107 @@
+/****************************************************************************
+  FileName     [ cirTruth.cpp ]
+  PackageName  [ cir ]
+  Synopsis     [ Define the truth-table checker of fraig ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2012-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#include <iostream>
+#include <cassert>
+#include "cirTruth.h"
+#include "cirGate.h"
+
+using namespace std;
+
+/*******************************/
+/*   Global variable and enum  */
+/*******************************/
+
+/**************************************/
+/*   Static varaibles and functions   */
+/**************************************/
+// the patterns of vars 0..5 within a word
+static const Simtype varWord[6] = {
+  0xaaaaaaaaaaaaaaaaULL, 0xccccccccccccccccULL, 0xf0f0f0f0f0f0f0f0ULL,
+  0xff00ff00ff00ff00ULL, 0xffff0000ffff0000ULL, 0xffffffff00000000ULL };
+
+/*******************************************/
+/*   class TruthChecker member functions   */
+/*******************************************/
+int TruthChecker::check(CirGate* g, CirGate* h, bool inv) {
+  if (++_stamp == 0) { _mark.assign(_mark.size(), 0); _stamp = 1; }
+  _supp.clear(); _cone.clear();
+  if (!collect(g) || !collect(h)) return -1;
+  const size_t k = _supp.size();
+  const size_t W = (k > 6 ? size_t(1) << (k - 6) : 1);
+  if ((_cone.size() + k + 1) * W > TRUTH_MAX_WORDS) return -1;
+  for (size_t c = 0; c < _cone.size(); ++c) _slot[_cone[c]->getId()] = k + 1 + c;
+
+  // table 0 is CONST 0, tables 1..k the support, then the cones
+  _tt.assign((_cone.size() + k + 1) * W, 0);
+  for (size_t v = 0; v < k; ++v) {
+    Simtype* t = &_tt[(v + 1) * W];
+    for (size_t w = 0; w < W; ++w)
+      t[w] = (v < 6 ? varWord[v] : ((w >> (v - 6)) & 1 ? ~Simtype(0) : 0));
+  }
+  for (size_t c = 0; c < _cone.size(); ++c) {
+    CirGate* a = _cone[c];
+    const CirGateV v0 = a->getfanin(0), v1 = a->getfanin(1);
+    const Simtype* t0 = &_tt[_slot[v0.gate()->getId()] * W];
+    const Simtype* t1 = &_tt[_slot[v1.gate()->getId()] * W];
+    const Simtype m0 = Simtype(0) - v0.isInv(), m1 = Simtype(0) - v1.isInv();
+    Simtype* t = &_tt[(k + 1 + c) * W];
+    for (size_t w = 0; w < W; ++w) t[w] = (t0[w] ^ m0) & (t1[w] ^ m1);
+  }
+  const Simtype* tg = &_tt[_slot[g->getId()] * W];
+  const Simtype* th = &_tt[_slot[h->getId()] * W];
+  const Simtype m = Simtype(0) - inv;
+  for (size_t w = 0; w < W; ++w) {
+    const Simtype d = tg[w] ^ th[w] ^ m;
+    if (!d) continue;
+    size_t b = 0;
+    while (!((d >> b) & 1)) ++b;
+    _diff = w * 64 + b;
+    return 1;
+  }
+  return 0;
+}
+
+int TruthChecker::value(const CirGate* g) const {
+  const unsigned id = g->getId();
+  if (id >= _mark.size() || _mark[id] != _stamp) return -1;
+  if (g->getType() != PI_GATE) return -1;
+  return (_diff >> (_slot[id] - 1)) & 1;
+}
+
+// Adds the cone of g to the support and the cones, in topological order;
+// returns false once either is too large. The PIs are the support; the
+// UNDEF gates read table 0 like CONST 0, as in simulation and in the SAT
+// encoding of fraig.
+bool TruthChecker::collect(CirGate* g) {
+  _stack.push_back(g);
+  while (_stack.size()) {
+    CirGate* t = _stack.back();
+    const unsigned id = t->getId();
+    if (_mark.size() <= id) { _mark.resize(id + 1, 0); _slot.resize(id + 1); }
+    if (_mark[id] == _stamp) { _stack.pop_back(); continue; }
+    if (t->getType() != AIG_GATE) {
+      _mark[id] = _stamp; _stack.pop_back();
+      if (t->getType() != PI_GATE) { _slot[id] = 0; continue; }
+      _supp.push_back(t);
+      _slot[id] = _supp.size();
+      if (_supp.size() > TRUTH_MAX_VARS) { _stack.clear(); return false; }
+      continue;
+    }
+    CirGate* f0 = t->getfanin(0).gate();
+    CirGate* f1 = t->getfanin(1).gate();
+    if (f0->getId() >= _mark.size() || _mark[f0->getId()] != _stamp) _stack.push_back(f0);
+    if (f1->getId() >= _mark.size() || _mark[f1->getId()] != _stamp) _stack.push_back(f1);
+    if (_stack.back() != t) continue;
+    _stack.pop_back();
+    _mark[id] = _stamp;
+    _cone.push_back(t);
+    if (_cone.size() > TRUTH_MAX_WORDS) { _stack.clear(); return false; }
+  }
+  return true;
+}
@@ -0,0 +1,54 @@
+/****************************************************************************
+  FileName     [ cirTruth.h ]
+  PackageName  [ cir ]
+  Synopsis     [ Define the truth-table checker of fraig ]
+  Author       [ Chung-Yang (Ric) Huang ]
+  Copyright    [ Copyleft(c) 2012-present LaDs(III), GIEE, NTU, Taiwan ]
+****************************************************************************/
+
+#ifndef CIR_TRUTH_H
+#define CIR_TRUTH_H
+
+#include <vector>
+#include "cirDef.h"
+
+using namespace std;
+
+// at most this many PIs in the support ...
+#define TRUTH_MAX_VARS  16
+// ... and at most this many words of tables for the cones, so that a
+// check never costs more than a cheap SAT call
+#define TRUTH_MAX_WORDS (1 << 16)
+
+// Decides a fraig pair exactly when the cones of both gates together
+// depend on few gates: each gate of the cones gets its truth table over
+// the support, 64 patterns a word. The gates are marked with stamps of
+// the checker, not with the global ref of CirGate, so that the threads
+// of fraig can have one each.
+class TruthChecker
+{
+public:
+  TruthChecker() : _stamp(0), _diff(0) {}
+  ~TruthChecker() {}
+
+  // 0 if g and h (inverted if inv) are equal, 1 if they are not, -1 if
+  // the support or the cones are too large
+  int check(CirGate* g, CirGate* h, bool inv);
+  // after check() returned 1: the value of g in a pattern that tells
+  // them apart, -1 if g is not in their support
+  int value(const CirGate* g) const;
+
+private:
+  vector<unsigned>  _mark;   // by gate id; _stamp if in the cones
+  vector<unsigned>  _slot;   // by gate id; table of the gate, or var of a support gate
+  unsigned          _stamp;
+  GateList          _supp;
+  GateList          _cone;   // the AIG gates, in topological order
+  GateList          _stack;
+  vector<Simtype>   _tt;
+  size_t            _diff;   // a pattern that tells the pair apart
+
+  bool collect(CirGate* g);
+};
+
+#endif // CIR_TRUTH_H
@@ -643,7 +643,8 @@ void Solver::simplifyDB()
 |  Output:
 |    'l_True' if a partial assigment that is consistent with respect to the clauseset is found. If
 |    all variables are decision variables, this means that the clause set is satisfiable. 'l_False'
-|    if the clause set is unsatisfiable. 'l_Undef' if the bound on number of conflicts is reached.
+|    if the clause set is unsatisfiable. 'l_Undef' if the bound on number of conflicts is reached,
+|    or a budget set by 'setConfBudget()'/'setPropBudget()' runs out.
 |________________________________________________________________________________________________@*/
 lbool Solver::search(int nof_conflicts, int nof_learnts, const SearchParams& params)
 {
@@ -678,8 +679,8 @@ lbool Solver::search(int nof_conflicts, int nof_learnts, const SearchParams& par
         }else{
             // NO CONFLICT
 
-            if (nof_conflicts >= 0 && conflictC >= nof_conflicts){
-                // Reached bound on number of conflicts:
+            if ((nof_conflicts >= 0 && conflictC >= nof_conflicts) || !withinBudget()){
+                // Reached bound on number of conflicts (or the budget):
                 progress_estimate = progressEstimate();
                 cancelUntil(root_level);
                 return l_Undef; }
@@ -757,9 +758,22 @@ void Solver::claRescaleActivity()
 |    not contain both 'x' and '~x' for any variable 'x'.
 |________________________________________________________________________________________________@*/
 bool Solver::solve(const vec<Lit>& assumps)
+{
+    return solveLimited(assumps) == l_True;
+}
+
+/*_________________________________________________________________________________________________
+|
+|  solveLimited : (assumps : const vec<Lit>&)  ->  [lbool]
+|  
+|  Description:
+|    Like 'solve()', but stops with 'l_Undef' once the conflict or propagation budget runs out.
+|    The solver stays usable; a later call continues from the learnt clauses it has.
+|________________________________________________________________________________________________@*/
+lbool Solver::solveLimited(const vec<Lit>& assumps)
 {
     simplifyDB();
-    if (!ok) return false;
+    if (!ok) return l_False;
 
     SearchParams    params(default_params);
     double  nof_conflicts = 100;
@@ -782,12 +796,12 @@ bool Solver::solve(const vec<Lit>& assumps)
                 if (proof != NULL) conflict_id = unit_id[var(p)];
             }
             cancelUntil(0);
-            return false; }
+            return l_False; }
         Clause* confl = propagate();
         if (confl != NULL){
             analyzeFinal(confl), assert(conflict.size() > 0);
             cancelUntil(0);
-            return false; }
+            return l_False; }
     }
     assert(root_level == decisionLevel());
 
@@ -803,7 +817,7 @@ bool Solver::solve(const vec<Lit>& assumps)
         reportf("===================================\n");
     }
 
-    while (status == l_Undef){
+    while (status == l_Undef && withinBudget()){
         if (verbosity >= 1){
             printStats();
             reportf("| %9d | %7d %8d | %7d %7d %8d %7.1f | %6.3f %% |\n",
@@ -821,7 +835,7 @@ bool Solver::solve(const vec<Lit>& assumps)
 
 if ((int)stats.conflicts >= effLimit) {
    cancelUntil(0);
-   return status == l_True;
+   return status;
 }
     }
     if (verbosity >= 1) {
@@ -830,7 +844,7 @@ if ((int)stats.conflicts >= effLimit) {
     }
 
     cancelUntil(0);
-    return status == l_True;
+    return status;
 }
 
 void Solver::printStats()
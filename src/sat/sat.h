@@ -65,12 +65,33 @@ class SatSolver
          _solver->addClause(lits); lits.clear();
       }
 
+      // "va != vb" guarded by the activation var act: the clauses only
+      // hold while act is assumed true, and retire(act) disables them
+      void addMiterCNF(Var act, Var va, bool fa, Var vb, bool fb) {
+         Lit la = fa? ~Lit(va): Lit(va);
+         Lit lb = fb? ~Lit(vb): Lit(vb);
+         _solver->addTernary(~Lit(act), la, lb);
+         _solver->addTernary(~Lit(act), ~la, ~lb);
+      }
+      // the clauses of act are satisfied at the top level from now on, and
+      // are removed by the next simplification of the solver
+      void retire(Var act) { _solver->addUnit(~Lit(act)); }
+
       // For incremental proof, use "assumeSolve()"
       void assumeRelease() { _assump.clear(); }
       void assumeProperty(Var prop, bool val) {
          _assump.push(val? Lit(prop): ~Lit(prop));
       }
       bool assumpSolve() { return _solver->solve(_assump); }
+      // Return 1/0/-1 for SAT/UNSAT/undecided; conflicts and props are
+      // the budgets of this call, and -1 means no limit
+      int assumpSolve(int conflicts, int props) {
+         _solver->setConfBudget(conflicts);
+         _solver->setPropBudget(props);
+         const lbool r = _solver->solveLimited(_assump);
+         _solver->budgetOff();
+         return (r == l_True? 1: (r == l_False? 0: -1));
+      }
 
       // For one time proof, use "solve"
       void assertProperty(Var prop, bool val) {
@@ -84,6 +105,8 @@ class SatSolver
          return (_solver->modelValue(v)==l_True?1:
                 (_solver->modelValue(v)==l_False?0:-1)); }
       void printStats() const { const_cast<Solver*>(_solver)->printStats(); }
+      int nVars() const { return _curVar; }
+      int nLearnts() const { return _solver->nLearnts(); }
 
    private : 
       Solver           *_solver;    // Pointer to a Minisat solver
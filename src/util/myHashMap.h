@@ -35,13 +35,14 @@ public:
    }
    ~SimKey() {}
    
+   // branch-free: the key is k or ~k, whichever is smaller
    void update(const Simtype& k) {
-     inv = false;
-     if (~k < k) {
-       inv = true;
-       _key = ~k;
-     } else _key = k;
+     const Simtype m = Simtype(0) - Simtype(~k < k);
+     _key = k ^ m;
+     inv = (m & 1);
    }
+   // key with a phase fixed by the caller
+   void set(const Simtype& k, bool i) { _key = k; inv = i; }
    Simtype operator () () const { return _key; }
    bool isInv() const { return inv; } 
 private: